@@ -0,0 +1,336 @@
+/*
+  ==============================================================================
+
+    Biquad.h
+
+    Lock-free biquad cascade with cached, block-interpolated coefficients.
+
+    juce::IIRFilter takes a lock in setCoefficients() and can only switch
+    coefficients between blocks, so the EQ used to rebuild and push every
+    band's coefficients on every callback and still zippered under
+    automation. Here the coefficient design lives in BiquadCoefficientCache,
+    which only recomputes when a band's (frequency, gain, Q, sample rate)
+    changes and then ramps linearly from the old to the new coefficients
+    across the block. Any number of sections (cascaded stages) can run from
+    one cache, and BiquadCascade runs a whole chain of them over all
+    channels in a single pass.
+
+    The designs and the transposed direct form II structure match
+    juce::IIRCoefficients / juce::IIRFilter, so a static EQ sounds the same.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FastMath.h"
+
+//==============================================================================
+/** Normalised biquad coefficients (a0 == 1). */
+struct BiquadCoefficients
+{
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+
+    static BiquadCoefficients makeHighPass (double sampleRate, double frequency, double Q) noexcept
+    {
+        const auto n = std::tan (juce::MathConstants<double>::pi * frequency / sampleRate);
+        const auto nSquared = n * n;
+        const auto c1 = 1.0 / (1.0 + 1.0 / Q * n + nSquared);
+
+        return normalise (c1, c1 * -2.0, c1, 1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - 1.0 / Q * n + nSquared));
+    }
+
+    static BiquadCoefficients makeLowPass (double sampleRate, double frequency, double Q) noexcept
+    {
+        const auto n = 1.0 / std::tan (juce::MathConstants<double>::pi * frequency / sampleRate);
+        const auto nSquared = n * n;
+        const auto c1 = 1.0 / (1.0 + 1.0 / Q * n + nSquared);
+
+        return normalise (c1, c1 * 2.0, c1, 1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - 1.0 / Q * n + nSquared));
+    }
+
+    static BiquadCoefficients makePeakFilter (double sampleRate, double frequency, double Q, double gainFactor) noexcept
+    {
+        const auto A = juce::jmax (0.0, std::sqrt (gainFactor));
+        const auto omega = (juce::MathConstants<double>::twoPi * juce::jmax (frequency, 2.0)) / sampleRate;
+        const auto alpha = 0.5 * std::sin (omega) / Q;
+        const auto c2 = -2.0 * std::cos (omega);
+        const auto alphaTimesA = alpha * A;
+        const auto alphaOverA = alpha / A;
+
+        return normalise (1.0 + alphaTimesA, c2, 1.0 - alphaTimesA, 1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+    }
+
+    bool operator== (const BiquadCoefficients& other) const noexcept
+    {
+        return b0 == other.b0 && b1 == other.b1 && b2 == other.b2 && a1 == other.a1 && a2 == other.a2;
+    }
+
+    bool operator!= (const BiquadCoefficients& other) const noexcept    { return ! operator== (other); }
+
+private:
+    static BiquadCoefficients normalise (double c0, double c1, double c2, double c3, double c4, double c5) noexcept
+    {
+        const auto a = 1.0 / c3;
+
+        return { static_cast<float> (c0 * a), static_cast<float> (c1 * a), static_cast<float> (c2 * a),
+                 static_cast<float> (c4 * a), static_cast<float> (c5 * a) };
+    }
+};
+
+//==============================================================================
+/**
+    The coefficients for one filter band, designed only when its parameters
+    change. After update(), sample i of the block (0-based) uses
+    start + step * (i + 1), so the last sample lands on the new design and the
+    ramp is finished by the next block.
+*/
+class BiquadCoefficientCache
+{
+public:
+    enum class Type { highPass, lowPass, peak };
+
+    explicit BiquadCoefficientCache (Type filterType = Type::peak) noexcept  : type (filterType) {}
+
+    /** Jumps straight to the next design instead of ramping (e.g. after prepare). */
+    void snapToTarget() noexcept
+    {
+        needsSnap = true;
+    }
+
+    /** Call once per block, before any Biquad::process() using this cache.
+        gainFactor is only used by peak filters.
+    */
+    void update (double sampleRate, float frequency, float Q, float gainFactor, int numSamples) noexcept
+    {
+        // The previous block's ramp (if any) ended on the target
+        start = target;
+        ramping = false;
+
+        const Key key { sampleRate, frequency, Q, gainFactor };
+
+        if (needsSnap || key != lastKey)
+        {
+            lastKey = key;
+            target = design (key);
+
+            if (needsSnap)
+            {
+                start = target;
+                needsSnap = false;
+            }
+        }
+
+        if (start != target && numSamples > 0)
+        {
+            const float scale = 1.0f / static_cast<float> (numSamples);
+            step = { (target.b0 - start.b0) * scale, (target.b1 - start.b1) * scale, (target.b2 - start.b2) * scale,
+                     (target.a1 - start.a1) * scale, (target.a2 - start.a2) * scale };
+            ramping = true;
+        }
+    }
+
+    bool isRamping() const noexcept                             { return ramping; }
+    const BiquadCoefficients& getStart() const noexcept         { return start; }
+    const BiquadCoefficients& getStep() const noexcept          { return step; }
+    const BiquadCoefficients& getTarget() const noexcept        { return target; }
+
+private:
+    struct Key
+    {
+        double sampleRate = 0.0;
+        float frequency = 0.0f, Q = 0.0f, gainFactor = 0.0f;
+
+        bool operator!= (const Key& other) const noexcept
+        {
+            return sampleRate != other.sampleRate || frequency != other.frequency
+                || Q != other.Q || gainFactor != other.gainFactor;
+        }
+    };
+
+    BiquadCoefficients design (const Key& key) const noexcept
+    {
+        switch (type)
+        {
+            case Type::highPass:    return BiquadCoefficients::makeHighPass (key.sampleRate, key.frequency, key.Q);
+            case Type::lowPass:     return BiquadCoefficients::makeLowPass (key.sampleRate, key.frequency, key.Q);
+            case Type::peak:
+            default:                return BiquadCoefficients::makePeakFilter (key.sampleRate, key.frequency, key.Q, key.gainFactor);
+        }
+    }
+
+    Type type;
+    Key lastKey;
+    BiquadCoefficients start, target, step;
+    bool ramping = false;
+    bool needsSnap = true;
+};
+
+//==============================================================================
+/**
+    A chain of biquad sections run over a block in one pass, with channels
+    side by side in the lanes of a Float4, four at a time.
+
+    Every sample is taken through all active sections while their state stays
+    in registers, so a 96 dB/oct setting reads and writes the buffer once
+    instead of once per stage and channel. The state belongs to a fixed slot
+    per section, so switching stages on and off (slope changes) behaves just
+    like a bank of separate filters. prepare() allocates the slots for each
+    group of four channels, so any channel layout works.
+*/
+class BiquadCascade
+{
+public:
+    static constexpr int maxSlots = 24;
+
+    void prepare (int numChannels)
+    {
+        groups.resize (static_cast<size_t> ((juce::jmax (1, numChannels) + lanes - 1) / lanes));
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& g : groups)
+            for (auto& s : g.slots)
+                s = {};
+    }
+
+    /** Starts a new section list; call once per block before addSection(). */
+    void clearSections() noexcept
+    {
+        numActive = 0;
+    }
+
+    /** Appends the section in the given state slot, using a cache that has
+        already been updated for this block.
+    */
+    void addSection (int slot, const BiquadCoefficientCache& coefficients) noexcept
+    {
+        jassert (juce::isPositiveAndBelow (slot, maxSlots) && numActive < maxSlots);
+        active[numActive++] = { slot, &coefficients };
+    }
+
+    /** Runs the prepared channels through the active sections, in place. */
+    void process (juce::AudioBuffer<float>& buffer) noexcept
+    {
+        jassert (buffer.getNumChannels() <= static_cast<int> (groups.size()) * lanes);
+        const int numChannels = juce::jmin (buffer.getNumChannels(), static_cast<int> (groups.size()) * lanes);
+        const int numSamples = buffer.getNumSamples();
+
+        if (numActive == 0 || numChannels == 0 || numSamples == 0)
+            return;
+
+        bool anyRamping = false;
+
+        for (int i = 0; i < numActive; ++i)
+            anyRamping = anyRamping || active[i].coefficients->isRamping();
+
+        float* const* channels = buffer.getArrayOfWritePointers();
+
+        for (int first = 0; first < numChannels; first += lanes)
+        {
+            auto& group = groups[static_cast<size_t> (first / lanes)];
+            const int numLanes = juce::jmin (lanes, numChannels - first);
+
+            if (anyRamping)
+                run<true> (channels + first, numLanes, numSamples, group);
+            else
+                run<false> (channels + first, numLanes, numSamples, group);
+        }
+    }
+
+private:
+    using Float4 = FastMath::Float4;
+    static constexpr int lanes = Float4::size;
+
+    struct State
+    {
+        Float4 z1 = Float4::broadcast (0.0f), z2 = Float4::broadcast (0.0f);
+    };
+
+    struct Section
+    {
+        int slot;
+        const BiquadCoefficientCache* coefficients;
+    };
+
+    struct LaneCoefficients
+    {
+        Float4 b0, b1, b2, a1, a2;
+
+        explicit LaneCoefficients (const BiquadCoefficients& c) noexcept
+            : b0 (Float4::broadcast (c.b0)), b1 (Float4::broadcast (c.b1)), b2 (Float4::broadcast (c.b2)),
+              a1 (Float4::broadcast (c.a1)), a2 (Float4::broadcast (c.a2)) {}
+
+        LaneCoefficients() noexcept  : LaneCoefficients (BiquadCoefficients()) {}
+
+        void advance (const LaneCoefficients& step) noexcept
+        {
+            b0 = b0 + step.b0;
+            b1 = b1 + step.b1;
+            b2 = b2 + step.b2;
+            a1 = a1 + step.a1;
+            a2 = a2 + step.a2;
+        }
+    };
+
+    /** The slots' state for four channels. */
+    struct Group
+    {
+        State slots[maxSlots];
+    };
+
+    template <bool ramping>
+    void run (float* const* channels, int numChannels, int numSamples, Group& group) noexcept
+    {
+        LaneCoefficients c[maxSlots], step[maxSlots];
+        State state[maxSlots];
+
+        for (int s = 0; s < numActive; ++s)
+        {
+            const auto& cache = *active[s].coefficients;
+            c[s] = LaneCoefficients (ramping ? cache.getStart() : cache.getTarget());
+
+            if (ramping)
+                step[s] = LaneCoefficients (cache.isRamping() ? cache.getStep() : BiquadCoefficients { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f });
+
+            state[s] = group.slots[active[s].slot];
+        }
+
+        alignas (16) float frame[lanes] = {};
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                frame[ch] = channels[ch][i];
+
+            auto x = Float4::load (frame);
+
+            for (int s = 0; s < numActive; ++s)
+            {
+                if (ramping)
+                    c[s].advance (step[s]);
+
+                // Transposed direct form II, as juce::IIRFilter
+                const auto out = c[s].b0 * x + state[s].z1;
+                state[s].z1 = c[s].b1 * x - c[s].a1 * out + state[s].z2;
+                state[s].z2 = c[s].b2 * x - c[s].a2 * out;
+                x = out;
+            }
+
+            x.store (frame);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                channels[ch][i] = frame[ch];
+        }
+
+        for (int s = 0; s < numActive; ++s)
+            group.slots[active[s].slot] = { FastMath::snapToZero (state[s].z1), FastMath::snapToZero (state[s].z2) };
+    }
+
+    std::vector<Group> groups { 1 };
+    Section active[maxSlots];
+    int numActive = 0;
+};
@@ -0,0 +1,468 @@
+/*
+  ==============================================================================
+
+    BufferSampler.h
+
+    In-memory sample source for the sampler.
+
+    SampleData owns an immutable AudioBuffer that is moved in rather than
+    copied, and is shared between sounds (and offline renders) by reference
+    count. BufferSamplerSound/BufferSamplerVoice are drop-in replacements for
+    juce::SamplerSound/SamplerVoice that play directly from it, so recordings
+    and jumbled takes become playable without a WAV encode/decode round-trip.
+
+    A sound can also stream from disk (see SampleStreamer.h). Its SampleData
+    then only holds the head of the file, and the voices read the rest from
+    their SampleStreams.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleStreamer.h"
+
+//==============================================================================
+/** Immutable, shareable sample audio plus the rate it was captured at. */
+struct SampleData
+{
+    using Ptr = std::shared_ptr<const SampleData>;
+
+    SampleData (juce::AudioBuffer<float>&& audioToAdopt, double sourceSampleRate)
+        : audio (std::move (audioToAdopt)), sampleRate (sourceSampleRate)
+    {
+    }
+
+    /** Takes ownership of the buffer without copying it. */
+    static Ptr adopt (juce::AudioBuffer<float>&& audioToAdopt, double sourceSampleRate)
+    {
+        return std::make_shared<const SampleData> (std::move (audioToAdopt), sourceSampleRate);
+    }
+
+    /** Decodes up to maxLengthSeconds of a file (at most two channels),
+        scaling it by gain.
+    */
+    static Ptr fromReader (juce::AudioFormatReader& reader, double maxLengthSeconds, float gain = 1.0f)
+    {
+        if (reader.sampleRate <= 0.0 || reader.lengthInSamples <= 0)
+            return {};
+
+        auto length = static_cast<int> (juce::jmin (reader.lengthInSamples,
+                                                    static_cast<juce::int64> (maxLengthSeconds * reader.sampleRate)));
+
+        juce::AudioBuffer<float> buffer (juce::jmin (2, static_cast<int> (reader.numChannels)), length);
+        reader.read (&buffer, 0, length, 0, true, true);
+
+        if (gain != 1.0f)
+            buffer.applyGain (gain);
+
+        return adopt (std::move (buffer), reader.sampleRate);
+    }
+
+    int getNumSamples() const noexcept          { return audio.getNumSamples(); }
+    double getLengthInSeconds() const noexcept  { return sampleRate > 0.0 ? getNumSamples() / sampleRate : 0.0; }
+
+    const juce::AudioBuffer<float> audio;
+    const double sampleRate;
+};
+
+//==============================================================================
+/**
+    A sampler sound that plays shared SampleData. Several sounds (and export
+    jobs) can reference the same data; the audio is freed with its last user.
+*/
+class BufferSamplerSound  : public juce::SynthesiserSound
+{
+public:
+    BufferSamplerSound (const juce::String& soundName,
+                        SampleData::Ptr sampleData,
+                        const juce::BigInteger& notes,
+                        int midiNoteForNormalPitch,
+                        double attackTimeSecs,
+                        double releaseTimeSecs)
+        : name (soundName),
+          data (std::move (sampleData)),
+          midiNotes (notes),
+          midiRootNote (midiNoteForNormalPitch)
+    {
+        jassert (data != nullptr);
+
+        params.attack  = static_cast<float> (attackTimeSecs);
+        params.release = static_cast<float> (releaseTimeSecs);
+    }
+
+    /** Streams from disk: sampleData is the head of the file, at its rate. */
+    BufferSamplerSound (const juce::String& soundName,
+                        SampleData::Ptr sampleData,
+                        DiskSampleSource::Ptr diskSource,
+                        const juce::BigInteger& notes,
+                        int midiNoteForNormalPitch,
+                        double attackTimeSecs,
+                        double releaseTimeSecs)
+        : BufferSamplerSound (soundName, std::move (sampleData), notes, midiNoteForNormalPitch, attackTimeSecs, releaseTimeSecs)
+    {
+        source = std::move (diskSource);
+        jassert (source != nullptr && source->getSampleRate() == data->sampleRate);
+    }
+
+    const juce::String& getName() const noexcept                { return name; }
+    const SampleData::Ptr& getSampleData() const noexcept       { return data; }
+    const juce::AudioBuffer<float>* getAudioData() const noexcept { return &data->audio; }
+    bool isStreamed() const noexcept                            { return source != nullptr; }
+
+    /** The whole sample's length, including any part that is streamed. */
+    juce::int64 getLengthInSamples() const noexcept
+    {
+        return source != nullptr ? source->getLengthInSamples() : data->getNumSamples();
+    }
+
+    double getLengthInSeconds() const noexcept                  { return getLengthInSamples() / data->sampleRate; }
+
+    void setEnvelopeParameters (juce::ADSR::Parameters parametersToUse)  { params = parametersToUse; }
+
+    //==============================================================================
+    bool appliesToNote (int midiNoteNumber) override    { return midiNotes[midiNoteNumber]; }
+    bool appliesToChannel (int) override                { return true; }
+
+private:
+    friend class BufferSamplerVoice;
+
+    juce::String name;
+    SampleData::Ptr data;
+    DiskSampleSource::Ptr source;
+    juce::BigInteger midiNotes;
+    int midiRootNote = 0;
+    juce::ADSR::Parameters params;
+
+    JUCE_LEAK_DETECTOR (BufferSamplerSound)
+};
+
+//==============================================================================
+/**
+    Plays a BufferSamplerSound with linear interpolation, like juce::SamplerVoice,
+    reading straight from the shared SampleData. The pitch is continuous: the
+    note sets an interval from the sound's root, and setPlaybackRate() scales
+    it by any ratio, even mid-note.
+
+    A streamed sound is read from its head until that runs out, and then from
+    this voice's own SampleStream (the one at streamIndex). If the reader
+    thread falls behind, the voice plays silence rather than waiting.
+
+    A note that is cut off (stolen, or stopped without a tail-off) fades out
+    over a few milliseconds instead of stopping dead. The fade renders
+    alongside whatever the voice plays next, so a stolen voice doesn't click.
+*/
+class BufferSamplerVoice  : public juce::SynthesiserVoice
+{
+public:
+    explicit BufferSamplerVoice (int streamIndexToUse = 0)  : streamIndex (streamIndexToUse) {}
+
+    bool canPlaySound (juce::SynthesiserSound* sound) override
+    {
+        return dynamic_cast<const BufferSamplerSound*> (sound) != nullptr;
+    }
+
+    void startNote (int midiNoteNumber, float velocity, juce::SynthesiserSound* s, int) override
+    {
+        if (auto* sound = dynamic_cast<const BufferSamplerSound*> (s))
+        {
+            notePitchRatio = std::pow (2.0, (midiNoteNumber - sound->midiRootNote) / 12.0)
+                                * sound->data->sampleRate / getSampleRate();
+
+            sourceSamplePosition = 0.0;
+            lgain = velocity;
+            rgain = velocity;
+            envelopeLevel = 0.0f;
+
+            // The head covers the start of the note while the stream fills
+            stream = sound->isStreamed() ? &sound->source->getStream (streamIndex) : nullptr;
+
+            if (stream != nullptr)
+                stream->start (sound->data->getNumSamples());
+
+            adsr.setSampleRate (sound->data->sampleRate);
+            adsr.setParameters (sound->params);
+            adsr.noteOn();
+        }
+        else
+        {
+            jassertfalse; // this object can only play BufferSamplerSounds!
+        }
+    }
+
+    void stopNote (float, bool allowTailOff) override
+    {
+        if (allowTailOff)
+        {
+            adsr.noteOff();
+        }
+        else
+        {
+            startCutFade();
+            endNote();
+        }
+    }
+
+    void pitchWheelMoved (int) override {}
+    void controllerMoved (int, int) override {}
+
+    //==============================================================================
+    /** Scales the pitch of this and later notes; 2.0 is an octave up. */
+    void setPlaybackRate (double newRate) noexcept      { playbackRate = newRate; }
+
+    /** Roughly how loud the voice is now (velocity times envelope). */
+    float getLevel() const noexcept                     { return isVoiceActive() ? lgain * envelopeLevel : 0.0f; }
+
+    /** Moves a sounding note to a position in the sample, in seconds of the
+        sample's own audio. Does nothing if the voice is idle.
+    */
+    void seek (double positionInSeconds) noexcept
+    {
+        if (auto* sound = static_cast<BufferSamplerSound*> (getCurrentlyPlayingSound().get()))
+        {
+            sourceSamplePosition = juce::jlimit (0.0, static_cast<double> (juce::jmax (juce::int64 (0), sound->getLengthInSamples() - 1)),
+                                                 positionInSeconds * sound->data->sampleRate);
+
+            if (stream != nullptr)
+                stream->start (getStreamFrame (*sound));
+        }
+    }
+
+    /** Drops a fade that's still running. Call this before the sound it reads
+        from can be released (e.g. when the sampler's sounds are replaced).
+    */
+    void clearCutFade() noexcept                        { fade = {}; }
+
+    //==============================================================================
+    void renderNextBlock (juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override
+    {
+        if (fade.remaining > 0)
+            renderCutFade (outputBuffer, startSample, numSamples);
+
+        auto* playingSound = static_cast<BufferSamplerSound*> (getCurrentlyPlayingSound().get());
+
+        if (playingSound == nullptr)
+            return;
+
+        auto& data = playingSound->data->audio;
+        const auto length = playingSound->getLengthInSamples();
+
+        if (length == 0)
+        {
+            endNote();
+            return;
+        }
+
+        const float* const inL = data.getReadPointer (0);
+        const float* const inR = data.getNumChannels() > 1 ? data.getReadPointer (1) : nullptr;
+
+        float* outL = outputBuffer.getWritePointer (0, startSample);
+        float* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer (1, startSample) : nullptr;
+
+        const double step = notePitchRatio * playbackRate;
+        const auto readyEnd = stream != nullptr ? stream->getReadyEnd() : juce::int64 (-1);
+
+        while (--numSamples >= 0)
+        {
+            float l, r;
+
+            if (stream != nullptr)
+                readStreamedFrame (inL, inR, data.getNumSamples(), readyEnd, length, sourceSamplePosition, l, r);
+            else
+                readFrame (inL, inR, static_cast<int> (length), sourceSamplePosition, l, r);
+
+            lastLeft = l;
+            lastRight = r;
+            envelopeLevel = adsr.getNextSample();
+
+            l *= lgain * envelopeLevel;
+            r *= rgain * envelopeLevel;
+
+            if (outR != nullptr)
+            {
+                *outL++ += l;
+                *outR++ += r;
+            }
+            else
+            {
+                *outL++ += (l + r) * 0.5f;
+            }
+
+            sourceSamplePosition += step;
+
+            if (sourceSamplePosition >= length || ! adsr.isActive())
+            {
+                endNote();
+                break;
+            }
+        }
+
+        // The reader may refill what this block has played
+        if (stream != nullptr)
+            stream->release (getStreamFrame (*playingSound));
+    }
+
+    using juce::SynthesiserVoice::renderNextBlock;
+
+private:
+    //==============================================================================
+    // just using a very simple linear interpolation here..
+    static void readFrame (const float* inL, const float* inR, int length, double position, float& l, float& r) noexcept
+    {
+        auto pos = static_cast<int> (position);
+        auto next = juce::jmin (pos + 1, length - 1);
+        auto alpha = static_cast<float> (position - pos);
+        auto invAlpha = 1.0f - alpha;
+
+        l = (inL[pos] * invAlpha + inL[next] * alpha);
+        r = (inR != nullptr) ? (inR[pos] * invAlpha + inR[next] * alpha) : l;
+    }
+
+    // The same, with frames past the head coming from the stream
+    void readStreamedFrame (const float* inL, const float* inR, int headLength, juce::int64 readyEnd,
+                            juce::int64 length, double position, float& l, float& r) const noexcept
+    {
+        auto pos = static_cast<juce::int64> (position);
+        auto next = juce::jmin (pos + 1, length - 1);
+        auto alpha = static_cast<float> (position - static_cast<double> (pos));
+        auto invAlpha = 1.0f - alpha;
+
+        float l0, r0, l1, r1;
+        streamedFrameAt (inL, inR, headLength, readyEnd, pos, l0, r0);
+        streamedFrameAt (inL, inR, headLength, readyEnd, next, l1, r1);
+
+        l = l0 * invAlpha + l1 * alpha;
+        r = r0 * invAlpha + r1 * alpha;
+    }
+
+    void streamedFrameAt (const float* inL, const float* inR, int headLength, juce::int64 readyEnd,
+                          juce::int64 frame, float& l, float& r) const noexcept
+    {
+        if (frame < headLength)
+        {
+            l = inL[frame];
+            r = (inR != nullptr) ? inR[frame] : l;
+        }
+        else if (frame < readyEnd)
+        {
+            stream->getFrame (frame, l, r);
+        }
+        else
+        {
+            l = r = 0.0f;   // the reader thread is behind
+        }
+    }
+
+    // Where the stream should be reading from: the play position, but never
+    // inside the head
+    juce::int64 getStreamFrame (const BufferSamplerSound& sound) const noexcept
+    {
+        return juce::jmax (static_cast<juce::int64> (sound.data->getNumSamples()),
+                           static_cast<juce::int64> (sourceSamplePosition));
+    }
+
+    void endNote()
+    {
+        if (stream != nullptr)
+            stream->stop();
+
+        stream = nullptr;
+        clearCurrentNote();
+        adsr.reset();
+    }
+
+    // Carries the note being cut on from where it is, fading to silence. Past
+    // a streamed sound's head the stream is needed for the next note, so the
+    // last frame played is faded out instead.
+    void startCutFade() noexcept
+    {
+        auto* sound = static_cast<BufferSamplerSound*> (getCurrentlyPlayingSound().get());
+        const float level = getLevel();
+
+        if (sound == nullptr || level <= 0.0f || sourceSamplePosition >= sound->getLengthInSamples())
+            return;
+
+        const bool inMemory = sourceSamplePosition < sound->data->getNumSamples();
+
+        fade.data = inMemory ? sound->data.get() : nullptr;
+        fade.position = sourceSamplePosition;
+        fade.step = notePitchRatio * playbackRate;
+        fade.heldLeft = lastLeft;
+        fade.heldRight = lastRight;
+        fade.gain = level;
+        fade.length = juce::jmax (1, juce::roundToInt (getSampleRate() * cutFadeSeconds));
+        fade.remaining = fade.length;
+    }
+
+    void renderCutFade (juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples) noexcept
+    {
+        const int length = fade.data != nullptr ? fade.data->getNumSamples() : 0;
+        const float* const inL = fade.data != nullptr ? fade.data->audio.getReadPointer (0) : nullptr;
+        const float* const inR = fade.data != nullptr && fade.data->audio.getNumChannels() > 1 ? fade.data->audio.getReadPointer (1) : nullptr;
+
+        float* outL = outputBuffer.getWritePointer (0, startSample);
+        float* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer (1, startSample) : nullptr;
+
+        for (int i = juce::jmin (numSamples, fade.remaining); --i >= 0;)
+        {
+            float l = fade.heldLeft, r = fade.heldRight;
+
+            if (fade.data != nullptr)
+            {
+                if (fade.position >= length)
+                {
+                    fade = {};
+                    return;
+                }
+
+                readFrame (inL, inR, length, fade.position, l, r);
+            }
+
+            const float gain = fade.gain * static_cast<float> (--fade.remaining) / static_cast<float> (fade.length);
+
+            if (outR != nullptr)
+            {
+                *outL++ += l * gain;
+                *outR++ += r * gain;
+            }
+            else
+            {
+                *outL++ += (l + r) * 0.5f * gain;
+            }
+
+            fade.position += fade.step;
+        }
+    }
+
+    //==============================================================================
+    static constexpr double cutFadeSeconds = 0.005;
+
+    const int streamIndex;
+    SampleStream* stream = nullptr;   // the playing sound's stream for this voice, if it streams
+
+    double notePitchRatio = 0.0;    // the note's interval and the rate conversion
+    double playbackRate = 1.0;      // the continuous pitch on top
+    double sourceSamplePosition = 0.0;
+    float lgain = 0.0f, rgain = 0.0f;
+    float envelopeLevel = 0.0f;
+    float lastLeft = 0.0f, lastRight = 0.0f;
+
+    juce::ADSR adsr;
+
+    // A cut note still fading out. It reads the sound's data directly, which
+    // the sampler keeps alive until clearCutFade() has been called. Without
+    // data it holds the last frame played.
+    struct CutFade
+    {
+        const SampleData* data = nullptr;
+        double position = 0.0, step = 0.0;
+        float heldLeft = 0.0f, heldRight = 0.0f;
+        float gain = 0.0f;
+        int length = 1, remaining = 0;
+    };
+
+    CutFade fade;
+
+    JUCE_LEAK_DETECTOR (BufferSamplerVoice)
+};
@@ -30,6 +30,8 @@ public:
     std::function<void(int, float, float)> onBandDragged;
     std::function<void(int, float)> onQChanged;
     std::function<void(int, float)> onSlopeChanged;
+    std::function<void(int)> onDragStarted;
+    std::function<void(int)> onDragEnded;
     
     juce::Colour getBandColor(int bandIndex) const
     {
@@ -197,6 +199,9 @@ public:
             draggedBand = hoveredBand;
             dragStartFreq = bandFreq[draggedBand];
             dragStartGain = bandGain[draggedBand];
+            
+            if (onDragStarted)
+                onDragStarted(draggedBand);
         }
     }
     
@@ -239,6 +244,9 @@ public:
     
     void mouseUp(const juce::MouseEvent& event) override
     {
+        if (draggedBand >= 0 && onDragEnded)
+            onDragEnded(draggedBand);
+        
         draggedBand = -1;
     }
     
@@ -277,9 +285,15 @@ public:
         }
     }
     
+    // The editor calls the setters from its timer to follow automation,
+    // so each one only repaints when something changed
+    
     // Set HPF parameters (band 0)
     void setHPF(float freq, float slope)
     {
+        if (bandFreq[0] == freq && bandQ[0] == slope / 12.0f && bandType[0] == FilterType::HighPass)
+            return;
+        
         bandFreq[0] = freq;
         bandQ[0] = slope / 12.0f; // Convert slope to Q-like value
         bandType[0] = FilterType::HighPass;
@@ -291,6 +305,10 @@ public:
     {
         if (index >= 1 && index <= 4)
         {
+            if (bandFreq[index] == freq && bandGain[index] == gain && bandQ[index] == q
+                 && bandType[index] == FilterType::Peak)
+                return;
+            
             bandFreq[index] = freq;
             bandGain[index] = gain;
             bandQ[index] = q;
@@ -302,6 +320,9 @@ public:
     // Set LPF parameters (band 5)
     void setLPF(float freq, float slope)
     {
+        if (bandFreq[5] == freq && bandQ[5] == slope / 12.0f && bandType[5] == FilterType::LowPass)
+            return;
+        
         bandFreq[5] = freq;
         bandQ[5] = slope / 12.0f;
         bandType[5] = FilterType::LowPass;
@@ -0,0 +1,915 @@
+/*
+  ==============================================================================
+
+    EffectsChain.h
+
+    The plugin's complete effects chain as a single reusable object.
+
+    Signal Flow:
+    Input Gain → 6-Band EQ (HPF, 4x Peak, LPF) → FET Compressor →
+          → Saturation (Tube processor or legacy model blend, oversampled) →
+          → Global Output + Soft Clipper
+
+    The realtime callback and the offline exporter both drive an instance of
+    this class, so a render goes through exactly the same code (and stage
+    order) as live playback. Parameters are passed in as a plain snapshot so
+    the chain itself knows nothing about where they come from.
+
+    Every stage keeps its state per channel (per group of four channels in
+    the Float4 kernels), sized in prepare(), so one instance can process any
+    bus layout from mono up to 7.1.4 and beyond.
+
+    process() first glides the snapshot's continuous parameters towards their
+    new values (smoothParameters()), and each stage then ramps from the
+    values it used last block, so automation doesn't zipper. See
+    ParameterSmoothing.h. The one switch that can't glide, between the tube
+    processor and the legacy blend (e.g. on a profile change), is
+    crossfaded by running both paths for a moment.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TubeSaturation.h"
+#include "FastMath.h"
+#include "Biquad.h"
+#include "FETCompressor.h"
+#include "Oversampler.h"
+#include "ParameterSmoothing.h"
+
+//==============================================================================
+/** A snapshot of every parameter the effects chain reads. Defaults match the
+    processor's initial parameter values.
+*/
+struct ChainParameters
+{
+    float gain = 0.7f;
+    bool bypass = false;
+
+    // Saturation
+    float saturation = 1.0f;
+    int saturationType = 1;     // 1=Tube, 2=Transistor, 3=Tape, 4=Diode, 5=Fuzz, 6=BitCrush
+
+    float tubeDrive = 4.0f, tubeWarmth = 0.5f, tubeBias = 0.0f, tubeOutput = 1.0f;
+    float transistorDrive = 4.0f, transistorBite = 0.5f, transistorClip = 0.5f, transistorOutput = 1.0f;
+    float tapeDrive = 4.0f, tapeWow = 0.2f, tapeHiss = 0.1f, tapeOutput = 1.0f;
+    float diodeDrive = 4.0f, diodeAsym = 0.5f, diodeClip = 0.5f, diodeOutput = 1.0f;
+    float fuzzDrive = 6.0f, fuzzGate = 0.2f, fuzzTone = 0.5f, fuzzOutput = 1.0f;
+    float bitDepth = 8.0f, bitRate = 4.0f, bitMix = 1.0f, bitOutput = 1.0f;
+
+    // 6-Band Parametric EQ
+    float hpfFreq = 20.0f, hpfSlope = 1.0f;
+    float peak1Freq = 200.0f,  peak1Gain = 0.0f, peak1Q = 1.0f;
+    float peak2Freq = 800.0f,  peak2Gain = 0.0f, peak2Q = 1.0f;
+    float peak3Freq = 2000.0f, peak3Gain = 0.0f, peak3Q = 1.0f;
+    float peak4Freq = 6000.0f, peak4Gain = 0.0f, peak4Q = 1.0f;
+    float lpfFreq = 20000.0f, lpfSlope = 1.0f;
+
+    // Compressor
+    float compThresh = -20.0f, compRatio = 4.0f, compAttack = 0.01f, compRelease = 0.1f, compMakeup = 0.0f;
+    float compLookahead = 0.0f;     // ms, 0 = off
+
+    // Saturation oversampling
+    int oversamplingFactor = 2;     // 1, 2, 4 or 8
+    bool linearPhaseOversampling = false;
+
+    // Global Output (dB)
+    float globalOutput = 0.0f;
+};
+
+//==============================================================================
+/**
+    Gain, EQ, FET compression, saturation and output stages with all of their
+    state. Each stage can also be run on its own (e.g. for profiling), but
+    process() is the only entry point that guarantees the canonical order.
+*/
+class EffectsChain
+{
+public:
+    EffectsChain() = default;
+    ~EffectsChain() = default;
+
+    //==============================================================================
+    void prepare (double sampleRate, int samplesPerBlock, int numChannels, const ChainParameters& initialParams)
+    {
+        currentSampleRate = sampleRate;
+        maxBlockSize = samplesPerBlock;
+        numChannels = juce::jmax (2, numChannels);
+
+        eqCascade.prepare (numChannels);
+        tubeSaturation.prepare (sampleRate, samplesPerBlock, numChannels);
+        legacyOversampler.prepare (sampleRate, samplesPerBlock, numChannels);
+        legacyStates.resize (static_cast<size_t> (numChannels));
+        legacyScratch.setSize (3, samplesPerBlock);
+        pathFadeScratch.setSize (numChannels, samplesPerBlock);
+        pathFadeLength = juce::jmax (1, juce::roundToInt (pathCrossfadeSeconds * sampleRate));
+        compressor.prepare (sampleRate, samplesPerBlock, numChannels);
+
+        // Start every smoother (and ramp) on the initial settings
+        for (size_t i = 0; i < std::size (smoothedFields); ++i)
+        {
+            smoothers[i].reset (sampleRate, smoothedFields[i].rampSeconds);
+            smoothers[i].setCurrentAndTargetValue (initialParams.*(smoothedFields[i].member));
+        }
+
+        smoothed = initialParams;
+
+        reset();
+
+        // Known up front, so the latency can be reported before the first block
+        compressor.setLookahead (getLookaheadSamples (initialParams));
+        updateOversampling (initialParams);
+    }
+
+    void reset()
+    {
+        // Reset all EQ filter stages, and start from the current settings
+        // rather than ramping in from the last ones
+        eqCascade.reset();
+        hpfCoeffs.snapToTarget();
+        lpfCoeffs.snapToTarget();
+
+        for (auto& band : peakCoeffs)
+            band.snapToTarget();
+
+        tubeSaturation.reset();
+        legacyOversampler.reset();
+
+        compressor.reset();
+
+        for (auto& state : legacyStates)
+            state = {};
+
+        // Start on the current path without fading in from the other one
+        tubePathActive = smoothed.saturationType == 1;
+        pathFadeRemaining = 0;
+
+        // Jump to the current targets rather than gliding in from old values
+        for (size_t i = 0; i < std::size (smoothedFields); ++i)
+        {
+            smoothers[i].setCurrentAndTargetValue (smoothers[i].getTargetValue());
+            smoothed.*(smoothedFields[i].member) = smoothers[i].getTargetValue();
+        }
+
+        lastInputGain = smoothed.gain;
+        lastOutputGain = juce::Decibels::decibelsToGain (smoothed.globalOutput);
+        lastSaturationMix = juce::jlimit (0.0f, 1.0f, smoothed.saturation);
+    }
+
+    double getSampleRate() const noexcept   { return currentSampleRate; }
+
+    /** The delay the chain adds (compressor lookahead plus the saturation's
+        oversampling filters), in samples. Both saturation paths use the same
+        oversampling settings, so either one's latency will do.
+    */
+    int getLatencySamples() const noexcept  { return compressor.getLatencySamples() + legacyOversampler.getLatencySamples(); }
+    int getMaxBlockSize() const noexcept    { return maxBlockSize; }
+
+    //==============================================================================
+    /** Runs the whole chain on one block, in place. A block longer than the
+        one prepare() was given is processed in pieces of getMaxBlockSize()
+        samples, since the oversampling and scratch buffers hold no more.
+    */
+    void process (juce::AudioBuffer<float>& buffer, const ChainParameters& target)
+    {
+        const int numSamples = buffer.getNumSamples();
+
+        if (numSamples <= maxBlockSize)
+        {
+            processBlock (buffer, target);
+            return;
+        }
+
+        for (int start = 0; start < numSamples; start += maxBlockSize)
+        {
+            const int num = juce::jmin (maxBlockSize, numSamples - start);
+            juce::AudioBuffer<float> block (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, num);
+            processBlock (block, target);
+        }
+    }
+
+    /** Runs a whole buffer through the chain in blocks of at most
+        getMaxBlockSize() samples, exactly as the audio callback would.
+    */
+    void processOffline (juce::AudioBuffer<float>& buffer, const ChainParameters& p)
+    {
+        process (buffer, p);
+    }
+
+    /** Moves every continuous parameter on by numSamples towards target and
+        returns the smoothed snapshot. Discrete settings (types, bypass,
+        oversampling, lookahead) pass straight through. Parameters that have
+        arrived cost one comparison each.
+    */
+    const ChainParameters& smoothParameters (const ChainParameters& target, int numSamples)
+    {
+        smoothed = target;
+
+        for (size_t i = 0; i < std::size (smoothedFields); ++i)
+        {
+            auto& smoother = smoothers[i];
+            smoother.setTargetValue (target.*(smoothedFields[i].member));
+
+            smoothed.*(smoothedFields[i].member) = smoother.isSmoothing() ? smoother.skip (numSamples)
+                                                                          : smoother.getTargetValue();
+        }
+
+        return smoothed;
+    }
+
+    //==============================================================================
+    // 1. Gain (applied first, before any processing)
+    void processInputGain (juce::AudioBuffer<float>& buffer, const ChainParameters& p)
+    {
+        BlockRamp::between (lastInputGain, p.gain, buffer.getNumSamples()).applyGain (buffer);
+        lastInputGain = p.gain;
+    }
+
+    // 2. 6-Band Parametric EQ - every active section in one pass over the block
+    void processEQ (juce::AudioBuffer<float>& buffer, const ChainParameters& p)
+    {
+        updateEQ (buffer.getNumSamples(), p);
+
+        eqCascade.clearSections();
+        addHighPassSections();
+        addPeakSections();
+        addLowPassSections();
+        eqCascade.process (buffer);
+    }
+
+    /** Advances the slope smoothing by one block and refreshes the EQ
+        coefficients. Bands whose settings haven't changed cost nothing; changed
+        ones are redesigned once and ramped across this block.
+    */
+    void updateEQ (int numSamples, const ChainParameters& p)
+    {
+        // Smooth slope parameter changes to avoid clicks
+        // The slopes arrive smoothed (see smoothParameters()); the stage count
+        // follows them a whole section at a time
+
+        // HPF (High-pass filter) - Use Butterworth response for smooth curves
+        float hpfSlopeValue = p.hpfSlope;
+        hpfStages = (hpfSlopeValue > 0.0f) ? juce::jlimit (1, 8, static_cast<int> (std::round (hpfSlopeValue))) : 0;
+
+        hpfCoeffs.update (currentSampleRate, p.hpfFreq, 0.707f, 1.0f, numSamples);
+
+        updatePeakCoefficients (0, p.peak1Freq, p.peak1Gain, p.peak1Q, numSamples);
+        updatePeakCoefficients (1, p.peak2Freq, p.peak2Gain, p.peak2Q, numSamples);
+        updatePeakCoefficients (2, p.peak3Freq, p.peak3Gain, p.peak3Q, numSamples);
+        updatePeakCoefficients (3, p.peak4Freq, p.peak4Gain, p.peak4Q, numSamples);
+
+        // LPF (Low-pass filter) - Use Butterworth response for smooth curves
+        float lpfSlopeValue = p.lpfSlope;
+        lpfStages = (lpfSlopeValue > 0.0f) ? juce::jlimit (1, 8, static_cast<int> (std::round (lpfSlopeValue))) : 0;
+
+        lpfCoeffs.update (currentSampleRate, p.lpfFreq, 0.707f, 1.0f, numSamples);
+    }
+
+    // The EQ's filter groups on their own (the benchmarks time them separately)
+    void processHighPass (juce::AudioBuffer<float>& buffer)
+    {
+        eqCascade.clearSections();
+        addHighPassSections();
+        eqCascade.process (buffer);
+    }
+
+    void processPeakBands (juce::AudioBuffer<float>& buffer)
+    {
+        eqCascade.clearSections();
+        addPeakSections();
+        eqCascade.process (buffer);
+    }
+
+    void processLowPass (juce::AudioBuffer<float>& buffer)
+    {
+        eqCascade.clearSections();
+        addLowPassSections();
+        eqCascade.process (buffer);
+    }
+
+    // 3. FET-Style Compression (1176-inspired)
+    void processCompressor (juce::AudioBuffer<float>& buffer, const ChainParameters& p)
+    {
+        compressor.setParameters (p.compThresh, p.compRatio, p.compAttack, p.compRelease, p.compMakeup);
+        compressor.setLookahead (getLookaheadSamples (p));
+        compressor.process (buffer);
+    }
+
+    // 4. Saturation (Post-Compression)
+    void processSaturation (juce::AudioBuffer<float>& buffer, const ChainParameters& p)
+    {
+        updateOversampling (p);
+
+        // Mode 1: Tube Saturation (dedicated processor with oversampling)
+        const bool useTube = p.saturationType == 1;
+        const int numSamples = buffer.getNumSamples();
+
+        if (useTube != tubePathActive)
+            switchSaturationPath (useTube);
+
+        // A block too big for the scratch buffer finishes the fade at once
+        if (pathFadeRemaining > 0 && numSamples > pathFadeScratch.getNumSamples())
+            pathFadeRemaining = 0;
+
+        if (pathFadeRemaining == 0)
+        {
+            processSaturationPath (useTube, buffer, p);
+            return;
+        }
+
+        // Both paths share the oversampling settings, so their outputs are
+        // time-aligned and can be mixed sample for sample
+        const int numChannels = buffer.getNumChannels();
+        juce::AudioBuffer<float> outgoing (pathFadeScratch.getArrayOfWritePointers(), numChannels, numSamples);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            outgoing.copyFrom (ch, 0, buffer, ch, 0, numSamples);
+
+        processSaturationPath (! useTube, outgoing, p);
+        processSaturationPath (useTube, buffer, p);
+
+        // Linear crossfade; it may finish part-way through the block
+        const int numToFade = juce::jmin (numSamples, pathFadeRemaining);
+        const auto length = static_cast<float> (pathFadeLength);
+        const float startGain = 1.0f - static_cast<float> (pathFadeRemaining) / length;
+        const float endGain = 1.0f - static_cast<float> (pathFadeRemaining - numToFade) / length;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            buffer.applyGainRamp (ch, 0, numToFade, startGain, endGain);
+            buffer.addFromWithRamp (ch, 0, outgoing.getReadPointer (ch), numToFade, 1.0f - startGain, 1.0f - endGain);
+        }
+
+        pathFadeRemaining -= numToFade;
+    }
+
+    void processSaturationPath (bool tube, juce::AudioBuffer<float>& buffer, const ChainParameters& p)
+    {
+        if (tube)
+            processTubeSaturation (buffer, p);
+        else
+            processLegacySaturation (buffer, p);     // Transistor, Tape, Diode, Fuzz, Bitcrusher
+    }
+
+    void processTubeSaturation (juce::AudioBuffer<float>& buffer, const ChainParameters& p)
+    {
+        // Map warmth 0-1 to dB range -12 to +6
+        float warmthDb = (p.tubeWarmth * 18.0f) - 12.0f;
+
+        // Map output 0-2 to dB range -12 to +12
+        float outputDb = (p.tubeOutput - 1.0f) * 12.0f;
+
+        tubeSaturation.setDrive (p.tubeDrive);
+        tubeSaturation.setWarmth (warmthDb);
+        tubeSaturation.setBias (p.tubeBias);     // already in the correct range -1 to +1
+        tubeSaturation.setOutputGain (outputDb);
+
+        // Process buffer with oversampled tube saturation
+        tubeSaturation.process (buffer);
+    }
+
+    // 5. Final Global Output Trim + Safety Limiter (applied to all modes)
+    void processOutput (juce::AudioBuffer<float>& buffer, const ChainParameters& p)
+    {
+        const int numSamples = buffer.getNumSamples();
+        const auto globalGain = nextOutputGain (p, numSamples);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            float* data = buffer.getWritePointer (ch);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                float sample = data[i] * globalGain.at<float> (i);
+
+                // NaN/Inf protection
+                if (std::isnan (sample) || std::isinf (sample))
+                    sample = 0.0f;
+
+                // Denormal protection
+                if (std::abs (sample) < 1e-15f)
+                    sample = 0.0f;
+
+                // Soft clipper/limiter (prevents runaway peaks)
+                if (sample > 1.0f)
+                    sample = 1.0f + std::tanh ((sample - 1.0f) * 0.5f) * 0.1f;
+                else if (sample < -1.0f)
+                    sample = -1.0f + std::tanh ((sample + 1.0f) * 0.5f) * 0.1f;
+
+                data[i] = sample;
+            }
+        }
+    }
+
+    // Blend of the six legacy saturation models
+    void processLegacySaturation (juce::AudioBuffer<float>& buffer, const ChainParameters& p)
+    {
+        // Read saturation parameters directly - NO profile-based modifiers
+        // This ensures manual parameter adjustments work correctly on ANY sample
+        const float satMix = juce::jlimit (0.0f, 1.0f, p.saturation);
+
+        // The models run oversampled. With the mix at zero the signal still
+        // goes through the filters, so the latency stays the same.
+        auto oversampled = legacyOversampler.processUp (buffer);
+        const int numSamples = oversampled.getNumSamples();
+
+        // The mix ramps per (oversampled) sample
+        const auto mix = BlockRamp::between (lastSaturationMix, satMix, numSamples);
+        lastSaturationMix = satMix;
+
+        if (mix.start > 0.0f || mix.end > 0.0f)
+        {
+            // Everything below is constant for the block, so it's worked out once
+            // here rather than per sample
+            const int factor = legacyOversampler.getFactor();
+            const auto blend = LegacyBlend::fromParameters (p, currentSampleRate * factor, factor);
+            const int numChannels = juce::jmin (oversampled.getNumChannels(), static_cast<int> (legacyStates.size()));
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* data = oversampled.getWritePointer (ch);
+                auto& state = legacyStates[static_cast<size_t> (ch)];
+
+                // The scratch buffers hold at most maxBlockSize samples
+                for (int start = 0; start < numSamples; start += maxBlockSize)
+                    processLegacyChannel (data + start, juce::jmin (maxBlockSize, numSamples - start), state, blend, mix, start);
+            }
+        }
+
+        legacyOversampler.processDown (buffer);
+    }
+
+private:
+    //==============================================================================
+    // process() for a block of at most maxBlockSize samples
+    void processBlock (juce::AudioBuffer<float>& buffer, const ChainParameters& target)
+    {
+        jassert (buffer.getNumSamples() <= maxBlockSize);
+        const auto& p = smoothParameters (target, buffer.getNumSamples());
+
+        if (p.bypass)
+        {
+            // When bypassed, still apply gain and global output, and keep the
+            // lookahead and oversampling delays so the reported latency doesn't change
+            processInputGain (buffer, p);
+            nextOutputGain (p, buffer.getNumSamples()).applyGain (buffer);
+            compressor.setLookahead (getLookaheadSamples (p));
+            compressor.processDelayOnly (buffer);
+            updateOversampling (p);
+            legacyOversampler.processUp (buffer);
+            legacyOversampler.processDown (buffer);
+            return;
+        }
+
+        processInputGain (buffer, p);
+        processEQ (buffer, p);
+        processCompressor (buffer, p);
+        processSaturation (buffer, p);
+        processOutput (buffer, p);
+    }
+
+    //==============================================================================
+    /** The legacy blend's per-block constants, fully wet (the mix is ramped
+        per sample on top). A model whose weight is zero contributes nothing
+        and is skipped entirely. The rate-dependent ones are scaled by the
+        oversampling factor so the models sound the same at any factor.
+    */
+    struct LegacyBlend
+    {
+        static constexpr float preAtten = 0.7f;  // Input attenuation for hot saturation modes (like real analog gear)
+
+        static LegacyBlend fromParameters (const ChainParameters& p, double sampleRate, int oversamplingFactor)
+        {
+            LegacyBlend b;
+
+            float tubeWeight = (p.tubeDrive / 10.0f) * 0.65f
+                             + p.tubeWarmth * 0.18f
+                             + std::abs (p.tubeBias) * 0.07f
+                             + std::abs (p.tubeOutput - 1.0f) * 0.10f;
+            float transistorWeight = (p.transistorDrive / 10.0f) * 0.55f
+                                   + p.transistorBite * 0.22f
+                                   + p.transistorClip * 0.13f
+                                   + std::abs (p.transistorOutput - 1.0f) * 0.10f;
+            float tapeWeight = (p.tapeDrive / 10.0f) * 0.55f
+                             + p.tapeWow * 0.18f
+                             + p.tapeHiss * 0.17f
+                             + std::abs (p.tapeOutput - 1.0f) * 0.10f;
+            float diodeWeight = (p.diodeDrive / 10.0f) * 0.55f
+                              + p.diodeAsym * 0.18f
+                              + p.diodeClip * 0.17f
+                              + std::abs (p.diodeOutput - 1.0f) * 0.10f;
+            float fuzzWeight = (p.fuzzDrive / 10.0f) * 0.55f
+                             + p.fuzzGate * 0.15f
+                             + (1.0f - p.fuzzTone) * 0.20f
+                             + std::abs (p.fuzzOutput - 1.0f) * 0.10f;
+            float depthWeight = (16.0f - p.bitDepth) / 14.0f;
+            float rateWeight = (p.bitRate - 1.0f) / 15.0f;
+            float bitWeight = p.bitMix * 0.55f
+                            + depthWeight * 0.2f
+                            + rateWeight * 0.15f
+                            + std::abs (p.bitOutput - 1.0f) * 0.10f;
+
+            tubeWeight = juce::jlimit (0.0f, 1.0f, tubeWeight);
+            transistorWeight = juce::jlimit (0.0f, 1.0f, transistorWeight);
+            tapeWeight = juce::jlimit (0.0f, 1.0f, tapeWeight);
+            diodeWeight = juce::jlimit (0.0f, 1.0f, diodeWeight);
+            fuzzWeight = juce::jlimit (0.0f, 1.0f, fuzzWeight);
+            bitWeight = juce::jlimit (0.0f, 1.0f, bitWeight);
+
+            const float focusBoost = 1.1f;
+            if (p.saturationType == 1) tubeWeight *= focusBoost;
+            if (p.saturationType == 2) transistorWeight *= focusBoost;
+            if (p.saturationType == 3) tapeWeight *= focusBoost;
+            if (p.saturationType == 4) diodeWeight *= focusBoost;
+            if (p.saturationType == 5) fuzzWeight *= focusBoost;
+            if (p.saturationType == 6) bitWeight *= focusBoost;
+
+            // processed = sum (out * weight) / weightSum, so the normalisation
+            // folds into the weights.
+            // With (almost) no weight at all the blend passes the dry signal.
+            const float weightSum = tubeWeight + transistorWeight + tapeWeight + diodeWeight + fuzzWeight + bitWeight;
+            const float scale = weightSum < 0.0001f ? 0.0f : 1.0f / weightSum;
+
+            b.dryGain = weightSum < 0.0001f ? 1.0f : 0.0f;
+            b.tubeWeight = tubeWeight * scale;
+            b.transistorWeight = transistorWeight * scale;
+            b.tapeWeight = tapeWeight * scale;
+            b.diodeWeight = diodeWeight * scale;
+            b.fuzzWeight = fuzzWeight * scale;
+            b.bitWeight = bitWeight * scale;
+
+            b.tubeDrive = 1.0f + p.tubeDrive * 0.6f;  // Increased for more extreme effect (max 7x)
+            b.tubeBias = p.tubeBias * 0.5f;  // Doubled bias shift for more pronounced effect
+            b.tubeWarm = (0.6f + p.tubeWarmth * 2.0f);  // Increased warmth effect
+            b.tubeEven = 0.25f * p.tubeWarmth;  // More even harmonics
+            b.tubeOut = p.tubeOutput / preAtten;  // Compensate attenuation
+
+            b.transDrive = 1.0f + p.transistorDrive * 0.6f;  // Increased for more extreme effect (max 7x)
+            b.transBite = juce::jlimit (0.0f, 1.0f, p.transistorBite);
+            b.transClip = 0.9f - (p.transistorClip * 0.7f);
+            b.transOut = p.transistorOutput / preAtten;  // Compensate attenuation
+
+            const float wowRate = 0.2f + (p.tapeWow * 2.0f);
+            b.wowInc = (juce::MathConstants<double>::twoPi * wowRate) / sampleRate;
+            b.wowDepth = p.tapeWow * 0.05f;  // More wow/flutter
+            b.tapeDrive = p.tapeDrive;  // Increased drive (max 11x)
+            b.tapeOut = (1.0f - p.tapeHiss * 0.6f) * p.tapeOutput / preAtten;  // More pronounced hiss/loss
+
+            b.diodeDrive = 1.0f + p.diodeDrive * 0.7f;  // Increased for more extreme effect (max 8x)
+            b.diodeAsym = juce::jlimit (0.0f, 1.0f, p.diodeAsym);
+            b.diodeClip = 0.95f - (p.diodeClip * 0.75f);
+            b.diodeSat = 1.2f + p.diodeClip * 2.0f;  // More harmonic distortion
+            b.diodeOut = p.diodeOutput / preAtten;  // Compensate attenuation
+
+            b.fuzzDrive = 1.0f + p.fuzzDrive * 0.7f;  // Increased for more extreme effect (max 8x)
+            b.fuzzGate = p.fuzzGate * 0.12f;  // More aggressive gating
+            b.fuzzAlpha = 0.08f + (1.0f - juce::jlimit (0.0f, 1.0f, p.fuzzTone)) * 0.6f;  // More extreme tone shaping
+            b.fuzzAlpha = 1.0f - std::pow (1.0f - b.fuzzAlpha, 1.0f / static_cast<float> (oversamplingFactor));  // same cutoff when oversampled
+            b.fuzzOut = p.fuzzOutput / preAtten;  // Compensate attenuation
+
+            const int bits = juce::jlimit (2, 16, static_cast<int> (std::round (p.bitDepth)));
+            b.crushRate = juce::jlimit (1, 16, static_cast<int> (std::round (p.bitRate))) * oversamplingFactor;
+            b.crushStep = 2.0f / static_cast<float> (1 << bits);
+            b.crushWet = juce::jlimit (0.0f, 1.0f, p.bitMix);
+            b.crushOut = p.bitOutput / preAtten;  // Compensate attenuation
+
+            return b;
+        }
+
+        float dryGain = 1.0f;
+        float tubeWeight = 0.0f, transistorWeight = 0.0f, tapeWeight = 0.0f, diodeWeight = 0.0f, fuzzWeight = 0.0f, bitWeight = 0.0f;
+
+        float tubeDrive, tubeBias, tubeWarm, tubeEven, tubeOut;
+        float transDrive, transBite, transClip, transOut;
+        double wowInc;
+        float wowDepth, tapeDrive, tapeOut;
+        float diodeDrive, diodeAsym, diodeClip, diodeSat, diodeOut;
+        float fuzzDrive, fuzzGate, fuzzAlpha, fuzzOut;
+        int crushRate;
+        float crushStep, crushWet, crushOut;
+    };
+
+    /** Per-channel state of the legacy models. */
+    struct LegacyState
+    {
+        double tapeWowPhase = 0.0;
+        float fuzzTone = 0.0f;
+        int crushCounter = 0;
+        float crushHold = 0.0f;
+    };
+
+    /** The stateless models (tube, transistor, tape, diode) for one sample or
+        four at once, already weighted. tapeDrive carries the wow modulation.
+    */
+    template <typename T>
+    static T legacyStatelessModels (T x, T tapeDrive, const LegacyBlend& b) noexcept
+    {
+        T wet = FastMath::broadcast<T> (0.0f);
+
+        if (b.tubeWeight > 0.0f)
+        {
+            const T driven = (x + b.tubeBias) * b.tubeDrive;
+            const T even = FastMath::abs (driven) * driven * b.tubeEven;
+            const T sat = FastMath::tanh ((driven + even) * b.tubeWarm);
+            const T comp = 1.0f / (FastMath::abs (sat) * 0.6f + 1.0f);
+            wet = wet + sat * comp * (b.tubeOut * b.tubeWeight);
+        }
+
+        if (b.transistorWeight > 0.0f)
+        {
+            const T clipped = FastMath::clamp (x * b.transDrive, -b.transClip, b.transClip);
+            const T soft = FastMath::tanh (clipped * (1.0f + b.transBite * 4.0f));  // More aggressive bite effect
+            const T hard = clipped * (1.0f / b.transClip);
+            T sat = FastMath::clamp (soft * (1.0f - b.transBite) + hard * b.transBite, -1.0f, 1.0f);
+
+            // Add crossover distortion (transistor characteristic)
+            sat = sat + sat * (1.0f - FastMath::abs (sat)) * (0.05f * b.transBite);
+            wet = wet + sat * (b.transOut * b.transistorWeight);
+        }
+
+        if (b.tapeWeight > 0.0f)
+        {
+            const T driven = x * tapeDrive;
+            const T comp = driven / (FastMath::abs (driven) * 0.7f + 1.0f);
+            wet = wet + FastMath::tanh (comp * 1.12f) * (b.tapeOut * b.tapeWeight);
+        }
+
+        if (b.diodeWeight > 0.0f)
+        {
+            const T clipped = FastMath::clamp (x * b.diodeDrive, -b.diodeClip, b.diodeClip);
+            T rect = clipped * (1.0f - b.diodeAsym) + FastMath::abs (clipped) * b.diodeAsym;
+
+            // Forward voltage drop simulation (0.6V diode characteristic, normalized)
+            rect = FastMath::copySign (FastMath::max (FastMath::abs (rect) - 0.06f, FastMath::broadcast<T> (0.0f)), rect);
+            wet = wet + FastMath::tanh (rect * b.diodeSat) * (b.diodeOut * b.diodeWeight);
+        }
+
+        return wet;
+    }
+
+    /** One channel of the blend, in place. offset is where data starts in
+        the block the mix ramp spans.
+    */
+    void processLegacyChannel (float* data, int numSamples, LegacyState& state, const LegacyBlend& b, const BlockRamp& mix, int offset)
+    {
+        using FastMath::Float4;
+
+        auto* dryScaled = legacyScratch.getWritePointer (0);
+        auto* tapeDrive = legacyScratch.getWritePointer (1);
+        auto* wet = legacyScratch.getWritePointer (2);
+
+        for (int i = 0; i < numSamples; ++i)
+            dryScaled[i] = data[i] * LegacyBlend::preAtten;
+
+        // Tape wow: a rotating phasor instead of a sin() per sample, re-seeded
+        // from the exact phase every block so it can't drift
+        if (b.tapeWeight > 0.0f)
+        {
+            float s = static_cast<float> (std::sin (state.tapeWowPhase + b.wowInc));
+            float c = static_cast<float> (std::cos (state.tapeWowPhase + b.wowInc));
+            const float sinInc = static_cast<float> (std::sin (b.wowInc));
+            const float cosInc = static_cast<float> (std::cos (b.wowInc));
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                tapeDrive[i] = 1.0f + b.tapeDrive * (1.0f + s * b.wowDepth);
+
+                const float nextS = s * cosInc + c * sinInc;
+                c = c * cosInc - s * sinInc;
+                s = nextS;
+            }
+        }
+
+        state.tapeWowPhase = std::fmod (state.tapeWowPhase + b.wowInc * numSamples, juce::MathConstants<double>::twoPi);
+
+        // Stateless models, four samples at a time
+        int i = 0;
+
+        for (; i + Float4::size <= numSamples; i += Float4::size)
+            legacyStatelessModels (Float4::load (dryScaled + i), Float4::load (tapeDrive + i), b).store (wet + i);
+
+        for (; i < numSamples; ++i)
+            wet[i] = legacyStatelessModels (dryScaled[i], tapeDrive[i], b);
+
+        // Fuzz and bitcrusher carry state from sample to sample
+        if (b.fuzzWeight > 0.0f)
+        {
+            float fuzzState = state.fuzzTone;
+
+            for (i = 0; i < numSamples; ++i)
+            {
+                float fuzzed = juce::jlimit (-1.0f, 1.0f, dryScaled[i] * b.fuzzDrive);
+                if (std::abs (fuzzed) < b.fuzzGate)
+                    fuzzed *= std::abs (fuzzed) / juce::jmax (0.001f, b.fuzzGate);
+
+                // Add octave-up effect (fuzz characteristic - frequency doubling)
+                float octaveUp = std::abs (fuzzed) * fuzzed * 0.25f;  // More octave-up harmonics
+                fuzzed = fuzzed * 0.75f + octaveUp;  // Adjusted mix for stronger effect
+
+                fuzzState += b.fuzzAlpha * (fuzzed - fuzzState);
+                wet[i] += fuzzState * (b.fuzzOut * b.fuzzWeight);
+            }
+
+            state.fuzzTone = fuzzState;
+        }
+        else
+        {
+            state.fuzzTone = 0.0f;
+        }
+
+        if (b.bitWeight > 0.0f)
+        {
+            const float invStep = 1.0f / b.crushStep;   // exact: the step is a power of two
+
+            for (i = 0; i < numSamples; ++i)
+            {
+                float crushSample = dryScaled[i];
+                if (b.crushRate > 1)
+                {
+                    if (state.crushCounter <= 0)
+                    {
+                        state.crushHold = crushSample;
+                        state.crushCounter = b.crushRate - 1;
+                    }
+                    else
+                    {
+                        --state.crushCounter;
+                        crushSample = state.crushHold;
+                    }
+                }
+
+                float quant = std::floor (crushSample * invStep) * b.crushStep;
+                wet[i] += (dryScaled[i] * (1.0f - b.crushWet) + quant * b.crushWet) * (b.crushOut * b.bitWeight);
+            }
+        }
+
+        // Crossfade from the dry signal to the saturated one by the mix
+        FastMath::forEachSample (numSamples, [&] (auto tag, int n)
+        {
+            using T = decltype (tag);
+            const T dry = FastMath::load<T> (data + n);
+            const T saturated = dry * b.dryGain + FastMath::load<T> (wet + n);
+            FastMath::store (data + n, dry + (saturated - dry) * mix.at<T> (offset + n));
+        });
+    }
+
+    //==============================================================================
+    // HPF - Apply cascaded stages for Butterworth response (only if slope > 0)
+    void addHighPassSections()
+    {
+        for (int stage = 0; stage < hpfStages; ++stage)
+            eqCascade.addSection (hpfSlot + stage, hpfCoeffs);
+    }
+
+    void addPeakSections()
+    {
+        for (int band = 0; band < 4; ++band)
+            eqCascade.addSection (peakSlot + band, peakCoeffs[band]);
+    }
+
+    // LPF - Apply cascaded stages for Butterworth response (only if slope > 0)
+    void addLowPassSections()
+    {
+        for (int stage = 0; stage < lpfStages; ++stage)
+            eqCascade.addSection (lpfSlot + stage, lpfCoeffs);
+    }
+
+    /** The global output gain ramp for this block. */
+    BlockRamp nextOutputGain (const ChainParameters& p, int numSamples) noexcept
+    {
+        const float gain = juce::Decibels::decibelsToGain (p.globalOutput);
+        const auto ramp = BlockRamp::between (lastOutputGain, gain, numSamples);
+        lastOutputGain = gain;
+        return ramp;
+    }
+
+    /** Starts crossfading to the other saturation path. If a fade is still
+        running it turns round from where it is, so the level doesn't jump.
+    */
+    void switchSaturationPath (bool useTube)
+    {
+        tubePathActive = useTube;
+
+        if (pathFadeRemaining > 0)
+        {
+            pathFadeRemaining = pathFadeLength - pathFadeRemaining;
+            return;
+        }
+
+        // The incoming path last ran who knows when; start it from silence
+        // rather than from that old state
+        if (useTube)
+        {
+            tubeSaturation.reset();
+        }
+        else
+        {
+            legacyOversampler.reset();
+
+            for (auto& state : legacyStates)
+                state = {};
+        }
+
+        pathFadeRemaining = pathFadeLength;
+    }
+
+    int getLookaheadSamples (const ChainParameters& p) const noexcept
+    {
+        return juce::roundToInt (p.compLookahead * 0.001 * currentSampleRate);
+    }
+
+    /** Both saturation paths always share the same oversampling, so the
+        latency doesn't change with the saturation type.
+    */
+    void updateOversampling (const ChainParameters& p)
+    {
+        const auto mode = p.linearPhaseOversampling ? Oversampler::Mode::linearPhase : Oversampler::Mode::minimumPhase;
+
+        tubeSaturation.setOversampling (p.oversamplingFactor, mode);
+        legacyOversampler.setMode (mode);
+        legacyOversampler.setFactor (p.oversamplingFactor);
+    }
+
+    void updatePeakCoefficients (int band, float freq, float gainDb, float q, int numSamples)
+    {
+        peakCoeffs[band].update (currentSampleRate, freq, q, juce::Decibels::decibelsToGain (gainDb * 1.5f), numSamples);
+    }
+
+    //==============================================================================
+    // DSP state - 6-band parametric EQ
+    // Multiple stages for HPF/LPF to handle slope properly
+    // Every stage and channel of a band shares that band's cached coefficients
+    BiquadCascade eqCascade;
+    static constexpr int hpfSlot = 0;    // Up to 8 cascaded stages for 96dB/oct
+    static constexpr int peakSlot = 8;
+    static constexpr int lpfSlot = 12;   // Up to 8 cascaded stages for 96dB/oct
+    BiquadCoefficientCache hpfCoeffs { BiquadCoefficientCache::Type::highPass };
+    BiquadCoefficientCache peakCoeffs[4];
+    BiquadCoefficientCache lpfCoeffs { BiquadCoefficientCache::Type::lowPass };
+    int hpfStages = 0, lpfStages = 0;
+
+    // Parameter smoothing: the continuous parameters and how long each takes
+    // to glide to a new value, the smoothed snapshot, and where the per-sample
+    // ramps ended last block
+    struct SmoothedField
+    {
+        float ChainParameters::* member;
+        double rampSeconds;
+    };
+
+    static constexpr SmoothedField smoothedFields[]
+    {
+        { &ChainParameters::gain, 0.02 },
+        { &ChainParameters::saturation, 0.02 },
+        { &ChainParameters::tubeDrive, 0.02 }, { &ChainParameters::tubeWarmth, 0.02 },
+        { &ChainParameters::tubeBias, 0.02 }, { &ChainParameters::tubeOutput, 0.02 },
+        { &ChainParameters::transistorDrive, 0.02 }, { &ChainParameters::transistorBite, 0.02 },
+        { &ChainParameters::transistorClip, 0.02 }, { &ChainParameters::transistorOutput, 0.02 },
+        { &ChainParameters::tapeDrive, 0.02 }, { &ChainParameters::tapeWow, 0.02 },
+        { &ChainParameters::tapeHiss, 0.02 }, { &ChainParameters::tapeOutput, 0.02 },
+        { &ChainParameters::diodeDrive, 0.02 }, { &ChainParameters::diodeAsym, 0.02 },
+        { &ChainParameters::diodeClip, 0.02 }, { &ChainParameters::diodeOutput, 0.02 },
+        { &ChainParameters::fuzzDrive, 0.02 }, { &ChainParameters::fuzzGate, 0.02 },
+        { &ChainParameters::fuzzTone, 0.02 }, { &ChainParameters::fuzzOutput, 0.02 },
+        { &ChainParameters::bitDepth, 0.02 }, { &ChainParameters::bitRate, 0.02 },
+        { &ChainParameters::bitMix, 0.02 }, { &ChainParameters::bitOutput, 0.02 },
+        { &ChainParameters::hpfFreq, 0.02 }, { &ChainParameters::hpfSlope, 0.05 },
+        { &ChainParameters::peak1Freq, 0.02 }, { &ChainParameters::peak1Gain, 0.02 }, { &ChainParameters::peak1Q, 0.02 },
+        { &ChainParameters::peak2Freq, 0.02 }, { &ChainParameters::peak2Gain, 0.02 }, { &ChainParameters::peak2Q, 0.02 },
+        { &ChainParameters::peak3Freq, 0.02 }, { &ChainParameters::peak3Gain, 0.02 }, { &ChainParameters::peak3Q, 0.02 },
+        { &ChainParameters::peak4Freq, 0.02 }, { &ChainParameters::peak4Gain, 0.02 }, { &ChainParameters::peak4Q, 0.02 },
+        { &ChainParameters::lpfFreq, 0.02 }, { &ChainParameters::lpfSlope, 0.05 },
+        { &ChainParameters::compThresh, 0.02 }, { &ChainParameters::compRatio, 0.02 },
+        { &ChainParameters::compAttack, 0.02 }, { &ChainParameters::compRelease, 0.02 },
+        { &ChainParameters::compMakeup, 0.02 },
+        { &ChainParameters::globalOutput, 0.02 },
+    };
+
+    juce::SmoothedValue<float> smoothers[std::size (smoothedFields)];
+    ChainParameters smoothed;
+    float lastInputGain = 1.0f, lastOutputGain = 1.0f, lastSaturationMix = 0.0f;
+
+    // FET-style compressor
+    FETCompressor compressor;
+
+    // Tube saturation processor
+    TubeSaturation tubeSaturation;
+
+    // Legacy saturation state per channel, plus scratch for the dry, tape-drive and wet signals
+    std::vector<LegacyState> legacyStates;
+    juce::AudioBuffer<float> legacyScratch;
+    Oversampler legacyOversampler;
+
+    // Crossfade between the tube and legacy paths when the saturation type
+    // moves from one to the other; the outgoing path renders into the scratch
+    static constexpr double pathCrossfadeSeconds = 0.02;
+    juce::AudioBuffer<float> pathFadeScratch;
+    int pathFadeLength = 1, pathFadeRemaining = 0;
+    bool tubePathActive = true;
+
+    double currentSampleRate = 44100.0;
+    int maxBlockSize = 512;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EffectsChain)
+};
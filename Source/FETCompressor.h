@@ -0,0 +1,380 @@
+/*
+  ==============================================================================
+
+    FETCompressor.h
+
+    1176-inspired FET compressor, processed a block at a time.
+
+    Signal Flow:
+    Stereo-linked peak detector → [Lookahead window max] → dB (fast log2) →
+          → Soft-knee gain computer → Attack/release envelope →
+          → Gain (fast exp2) + FET colouration, applied to the [delayed] input
+
+    Only the envelope follower depends on the previous sample, so it is the
+    only scalar loop. The detector, the gain curve (branch-free, in the log
+    domain) and the gain/colouration stage run four samples at a time
+    through FastMath::Float4.
+
+    In lookahead mode the audio is delayed by the lookahead time while the
+    detector sees the loudest peak of the window ahead of it, so the gain is
+    already down when a transient arrives. The window maximum comes from a
+    monotonic deque (amortised O(1) per sample), and the delay is reported
+    through getLatencySamples() so the host can compensate.
+
+    Threshold and makeup ramp across each block from the values the last
+    block ended on (see ParameterSmoothing.h), so automating them doesn't
+    zipper.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FastMath.h"
+#include "ParameterSmoothing.h"
+
+//==============================================================================
+class FETCompressor
+{
+public:
+    FETCompressor() = default;
+    ~FETCompressor() = default;
+
+    //==============================================================================
+    /** Longest lookahead setLookahead() accepts. */
+    static constexpr double maxLookaheadSeconds = 0.01;
+
+    //==============================================================================
+    void prepare (double sampleRate, int samplesPerBlock, int numChannels)
+    {
+        currentSampleRate = sampleRate;
+        maxBlockSize = juce::jmax (1, samplesPerBlock);
+
+        // 0: detector / gain reduction in dB, 1: envelope, 2: linear gain
+        scratch.setSize (3, maxBlockSize);
+
+        maxLookahead = static_cast<int> (std::ceil (maxLookaheadSeconds * sampleRate));
+        lookahead = 0;  // set again by setLookahead() for the new rate
+        delayLine.setSize (juce::jmax (1, numChannels), juce::jmax (1, maxLookahead));
+        window.resize (static_cast<size_t> (maxLookahead + 2));
+
+        reset();
+    }
+
+    void reset()
+    {
+        envelope = 0.0f;
+        delayLine.clear();
+        delayPosition = 0;
+        windowStart = windowSize = 0;
+        sampleIndex = 0;
+
+        // Start the next block on the current settings instead of ramping
+        snapParameters = true;
+    }
+
+    /** Times are in seconds, threshold and makeup in dB. */
+    void setParameters (float thresholdDb, float ratio, float attackSeconds, float releaseSeconds, float makeupDb)
+    {
+        threshold = thresholdDb;
+        slope = 1.0f - 1.0f / ratio;
+        makeup = makeupDb;
+
+        // FET compressors have faster time constants
+        attackCoeff = 1.0f - std::exp (-1.0f / (attackSeconds * static_cast<float> (currentSampleRate) * 0.5f));
+        releaseCoeff = 1.0f - std::exp (-1.0f / (releaseSeconds * static_cast<float> (currentSampleRate)));
+    }
+
+    /** Lookahead in samples (0 = off). The envelope carries on through a
+        change, and the delay keeps its newest samples, so the audio skips
+        (shorter) or gaps (longer) by the difference rather than dropping out.
+    */
+    void setLookahead (int numSamples)
+    {
+        numSamples = juce::jlimit (0, maxLookahead, numSamples);
+
+        if (numSamples != lookahead)
+        {
+            resizeDelay (numSamples);
+            lookahead = numSamples;
+        }
+    }
+
+    /** The delay the lookahead adds to the signal. */
+    int getLatencySamples() const noexcept  { return lookahead; }
+
+    /** Current gain reduction in dB. */
+    float getEnvelope() const noexcept      { return envelope; }
+
+    //==============================================================================
+    void process (juce::AudioBuffer<float>& buffer)
+    {
+        const int numSamples = buffer.getNumSamples();
+        const int numChannels = buffer.getNumChannels();
+
+        if (numChannels == 0)
+            return;
+
+        // The scratch buffers hold at most maxBlockSize samples
+        for (int start = 0; start < numSamples; start += maxBlockSize)
+        {
+            const int num = juce::jmin (maxBlockSize, numSamples - start);
+            juce::AudioBuffer<float> block (buffer.getArrayOfWritePointers(), numChannels, start, num);
+            processBlock (block);
+        }
+    }
+
+    /** Only delays the signal by the lookahead, e.g. while bypassed, so the
+        reported latency stays true.
+    */
+    void processDelayOnly (juce::AudioBuffer<float>& buffer)
+    {
+        delay (buffer);
+    }
+
+private:
+    //==============================================================================
+    void processBlock (juce::AudioBuffer<float>& buffer)
+    {
+        const int numSamples = buffer.getNumSamples();
+        const int numChannels = buffer.getNumChannels();
+
+        auto* reduction = scratch.getWritePointer (0);
+        auto* env = scratch.getWritePointer (1);
+        auto* gain = scratch.getWritePointer (2);
+
+        if (snapParameters)
+        {
+            currentThreshold = threshold;
+            currentMakeup = makeup;
+            snapParameters = false;
+        }
+
+        const auto thresholdRamp = BlockRamp::between (currentThreshold, threshold, numSamples);
+        const auto makeupRamp = BlockRamp::between (currentMakeup, makeup, numSamples);
+        currentThreshold = threshold;
+        currentMakeup = makeup;
+
+        // 1. Peak detection, linked across channels
+        juce::FloatVectorOperations::abs (reduction, buffer.getReadPointer (0), numSamples);
+
+        for (int ch = 1; ch < numChannels; ++ch)
+        {
+            const auto* data = buffer.getReadPointer (ch);
+
+            FastMath::forEachSample (numSamples, [&] (auto tag, int i)
+            {
+                using T = decltype (tag);
+                const auto peak = FastMath::max (FastMath::load<T> (reduction + i), FastMath::abs (FastMath::load<T> (data + i)));
+                FastMath::store (reduction + i, peak);
+            });
+        }
+
+        // With lookahead, each sample's detector value is the loudest peak
+        // of the window it is about to be part of
+        if (lookahead > 0)
+            applyLookaheadWindow (reduction, numSamples);
+
+        // 2. Gain computer: peak to dB, then the static curve
+        FastMath::forEachSample (numSamples, [&] (auto tag, int i)
+        {
+            using T = decltype (tag);
+            FastMath::store (reduction + i, gainReduction (decibels (FastMath::load<T> (reduction + i)), thresholdRamp.at<T> (i)));
+        });
+
+        // 3. Envelope follower with FET-style timing
+        auto e = envelope;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float coeff = (reduction[i] > e) ? attackCoeff : releaseCoeff;
+            e += (reduction[i] - e) * coeff;
+
+            // Denormal protection for envelope
+            if (std::abs (e) < 1e-15f)
+                e = 0.0f;
+
+            env[i] = e;
+        }
+
+        envelope = e;
+
+        // 4. Makeup gain minus the envelope, back to linear
+        FastMath::forEachSample (numSamples, [&] (auto tag, int i)
+        {
+            using T = decltype (tag);
+            FastMath::store (gain + i, FastMath::exp2 ((makeupRamp.at<T> (i) - FastMath::load<T> (env + i)) * dBToLog2));
+        });
+
+        // 5. Apply compression with makeup gain and FET-style slight odd harmonics
+        delay (buffer);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* data = buffer.getWritePointer (ch);
+
+            FastMath::forEachSample (numSamples, [&] (auto tag, int i)
+            {
+                using T = decltype (tag);
+                FastMath::store (data + i, applyGain (FastMath::load<T> (data + i), FastMath::load<T> (env + i), FastMath::load<T> (gain + i)));
+            });
+        }
+    }
+
+    //==============================================================================
+    /** Sliding maximum over the last lookahead + 1 detector values. The deque
+        holds candidates in decreasing order; each value is pushed and popped
+        at most once.
+    */
+    void applyLookaheadWindow (float* peaks, int numSamples) noexcept
+    {
+        const auto capacity = static_cast<int> (window.size());
+
+        for (int i = 0; i < numSamples; ++i, ++sampleIndex)
+        {
+            // Smaller values behind a new one can never be the maximum again
+            while (windowSize > 0 && window[static_cast<size_t> ((windowStart + windowSize - 1) % capacity)].value <= peaks[i])
+                --windowSize;
+
+            window[static_cast<size_t> ((windowStart + windowSize) % capacity)] = { sampleIndex, peaks[i] };
+            ++windowSize;
+
+            // Drop the front once it has slid out of the window (several
+            // entries at once after the lookahead got shorter)
+            while (windowSize > 1 && window[static_cast<size_t> (windowStart)].index < sampleIndex - lookahead)
+            {
+                windowStart = (windowStart + 1) % capacity;
+                --windowSize;
+            }
+
+            peaks[i] = window[static_cast<size_t> (windowStart)].value;
+        }
+    }
+
+    /** Delays every channel by the lookahead: each stretch of the block is
+        swapped with the ring buffer, which holds the previous samples.
+    */
+    void delay (juce::AudioBuffer<float>& buffer) noexcept
+    {
+        if (lookahead == 0)
+            return;
+
+        const int numSamples = buffer.getNumSamples();
+        const int numChannels = juce::jmin (buffer.getNumChannels(), delayLine.getNumChannels());
+        jassert (buffer.getNumChannels() <= delayLine.getNumChannels());
+
+        int position = delayPosition;
+
+        for (int done = 0; done < numSamples;)
+        {
+            const int num = juce::jmin (numSamples - done, lookahead - position);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* data = buffer.getWritePointer (ch, done);
+                std::swap_ranges (data, data + num, delayLine.getWritePointer (ch, position));
+            }
+
+            done += num;
+            position = (position + num) % lookahead;
+        }
+
+        delayPosition = position;
+    }
+
+    /** Puts the ring in oldest-first order and keeps its newest samples: the
+        oldest are dropped when it shrinks, silence goes in front when it grows.
+    */
+    void resizeDelay (int newLength) noexcept
+    {
+        for (int ch = 0; ch < delayLine.getNumChannels(); ++ch)
+        {
+            auto* data = delayLine.getWritePointer (ch);
+            std::rotate (data, data + delayPosition, data + lookahead);
+
+            if (newLength <= lookahead)
+            {
+                std::copy (data + lookahead - newLength, data + lookahead, data);
+            }
+            else
+            {
+                std::copy_backward (data, data + lookahead, data + newLength);
+                std::fill (data, data + newLength - lookahead, 0.0f);
+            }
+        }
+
+        delayPosition = 0;
+    }
+
+    //==============================================================================
+    static constexpr float kneeWidth = 6.0f;    // Soft knee width in dB for FET character
+    static constexpr float log2ToDB = 6.0205999f;   // 20 * log10 (2)
+    static constexpr float dBToLog2 = 1.0f / log2ToDB;
+
+    template <typename T>
+    static T decibels (T peak) noexcept
+    {
+        return FastMath::log2 (peak + 0.0001f) * log2ToDB;
+    }
+
+    /** Soft-knee curve without branches: the squared term covers the knee,
+        the linear term everything above it, and both are zero below.
+    */
+    template <typename T>
+    T gainReduction (T peakDb, T thresholdDb) const noexcept
+    {
+        const T overKneeStart = peakDb - (thresholdDb - kneeWidth / 2.0f);
+        const T inKnee = FastMath::clamp (overKneeStart, 0.0f, kneeWidth);
+        const T aboveKnee = FastMath::max (overKneeStart - kneeWidth, FastMath::broadcast<T> (0.0f));
+
+        T reduction = (inKnee * inKnee * (1.0f / (2.0f * kneeWidth)) + aboveKnee) * slope;
+
+        // Add FET-style harmonic saturation at high compression (more pronounced)
+        const T satAmount = FastMath::max (reduction - 10.0f, FastMath::broadcast<T> (0.0f)) * 0.05f;
+        return reduction + satAmount * satAmount;
+    }
+
+    template <typename T>
+    static T applyGain (T input, T env, T gain) noexcept
+    {
+        const T zero = FastMath::broadcast<T> (0.0f);
+        T sample = input * gain;
+
+        // FET-style coloration (odd harmonics) when compressing - more pronounced
+        const T colorAmount = FastMath::selectIfGreater (env, FastMath::broadcast<T> (3.0f),
+                                                         FastMath::min (env * 0.02f, FastMath::broadcast<T> (0.15f)), zero);
+        sample = sample + colorAmount * FastMath::tanh (sample * 3.0f) * 0.2f;
+
+        // NaN/Inf protection: anything that isn't below infinity falls back to unprocessed
+        return FastMath::selectIfGreater (FastMath::broadcast<T> (std::numeric_limits<float>::infinity()),
+                                          FastMath::abs (sample), sample, input);
+    }
+
+    //==============================================================================
+    double currentSampleRate = 44100.0;
+    int maxBlockSize = 512;
+    juce::AudioBuffer<float> scratch;
+
+    float threshold = -20.0f, slope = 0.75f, makeup = 0.0f;
+    float currentThreshold = -20.0f, currentMakeup = 0.0f;     // where the last block's ramps ended
+    bool snapParameters = true;
+    float attackCoeff = 1.0f, releaseCoeff = 1.0f;
+    float envelope = 0.0f;
+
+    // Lookahead
+    struct WindowEntry
+    {
+        juce::int64 index;
+        float value;
+    };
+
+    int lookahead = 0, maxLookahead = 0;
+    juce::AudioBuffer<float> delayLine;
+    int delayPosition = 0;
+    std::vector<WindowEntry> window;
+    int windowStart = 0, windowSize = 0;
+    juce::int64 sampleIndex = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FETCompressor)
+};
@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    FactoryPresets.h
+
+    The factory preset bank, in the same JSON format as the banks loaded
+    from disk (see PresetBank.h). "defaults" lists every parameter a preset
+    controls and the value it gets when a preset doesn't mention it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace FactoryPresets
+{
+    static const char* const bank = R"json(
+{
+  "name": "Factory",
+  "defaults": {
+    "gain": 0.7, "pitch": 1.0,
+    "compThresh": -20.0, "compRatio": 4.0, "compAttack": 0.01, "compRelease": 0.1, "compMakeup": 0.0, "compLookahead": 0.0,
+    "saturation": 0.0, "saturationType": 1,
+    "tubeDrive": 0.0, "tubeWarmth": 0.0, "tubeBias": 0.0, "tubeOutput": 1.0,
+    "transistorDrive": 0.0, "transistorBite": 0.0, "transistorClip": 0.5, "transistorOutput": 1.0,
+    "tapeDrive": 0.0, "tapeWow": 0.0, "tapeHiss": 0.0, "tapeOutput": 1.0,
+    "diodeDrive": 0.0, "diodeAsym": 0.5, "diodeClip": 0.5, "diodeOutput": 1.0,
+    "fuzzDrive": 0.0, "fuzzGate": 0.0, "fuzzTone": 0.5, "fuzzOutput": 1.0,
+    "bitDepth": 16.0, "bitRate": 1.0, "bitMix": 0.0, "bitOutput": 1.0,
+    "hpfFreq": 20.0, "hpfSlope": 1.0,
+    "peak1Freq": 200.0, "peak1Gain": 0.0, "peak1Q": 1.0,
+    "peak2Freq": 1000.0, "peak2Gain": 0.0, "peak2Q": 1.0,
+    "peak3Freq": 3000.0, "peak3Gain": 0.0, "peak3Q": 1.0,
+    "peak4Freq": 6000.0, "peak4Gain": 0.0, "peak4Q": 1.0,
+    "lpfFreq": 20000.0
+  },
+  "presets": [
+    { "name": "-init-" },
+
+    { "name": "Wax Cylinder",
+      "saturation": 1.0, "saturationType": 1,
+      "tubeDrive": 7.0, "tubeWarmth": 0.8, "tubeBias": 0.3, "tubeOutput": 1.0,
+      "hpfFreq": 50.0,
+      "peak1Freq": 200.0, "peak1Gain": 4.0, "peak1Q": 0.8,
+      "peak2Freq": 800.0, "peak2Gain": 2.0, "peak2Q": 0.9,
+      "peak3Freq": 2500.0, "peak3Gain": -2.0, "peak3Q": 1.0,
+      "peak4Freq": 6000.0, "peak4Gain": -6.0, "peak4Q": 0.7,
+      "lpfFreq": 8000.0 },
+
+    { "name": "Vinyl",
+      "saturation": 1.0, "saturationType": 3,
+      "tapeDrive": 5.0, "tapeWow": 0.15, "tapeHiss": 0.4, "tapeOutput": 1.0,
+      "hpfFreq": 40.0,
+      "peak1Freq": 150.0, "peak1Gain": 3.0, "peak1Q": 0.7,
+      "peak2Freq": 1000.0, "peak2Gain": 1.0, "peak2Q": 1.0,
+      "peak3Freq": 3000.0, "peak3Gain": 2.0, "peak3Q": 1.2,
+      "peak4Freq": 7000.0, "peak4Gain": -3.0, "peak4Q": 0.8,
+      "lpfFreq": 12000.0 },
+
+    { "name": "Cassette",
+      "saturation": 1.0, "saturationType": 3,
+      "tapeDrive": 6.0, "tapeWow": 0.7, "tapeHiss": 0.6, "tapeOutput": 0.95,
+      "hpfFreq": 60.0,
+      "peak1Freq": 180.0, "peak1Gain": 2.5, "peak1Q": 0.8,
+      "peak2Freq": 900.0, "peak2Gain": -1.0, "peak2Q": 1.1,
+      "peak3Freq": 2800.0, "peak3Gain": 1.5, "peak3Q": 0.9,
+      "peak4Freq": 5000.0, "peak4Gain": -5.0, "peak4Q": 0.7,
+      "lpfFreq": 7000.0 },
+
+    { "name": "Reel to Reel",
+      "saturation": 1.0, "saturationType": 3,
+      "tapeDrive": 3.0, "tapeWow": 0.05, "tapeHiss": 0.05, "tapeOutput": 1.0,
+      "hpfFreq": 20.0,
+      "peak1Freq": 200.0, "peak1Gain": 0.0, "peak1Q": 1.0,
+      "peak2Freq": 1000.0, "peak2Gain": 0.0, "peak2Q": 1.0,
+      "peak3Freq": 3000.0, "peak3Gain": 0.0, "peak3Q": 1.0,
+      "peak4Freq": 6000.0, "peak4Gain": 0.0, "peak4Q": 1.0,
+      "lpfFreq": 20000.0 },
+
+    { "name": "Neve",
+      "saturation": 1.0, "saturationType": 1,
+      "tubeDrive": 4.0, "tubeWarmth": 0.7, "tubeBias": 0.1, "tubeOutput": 1.05,
+      "hpfFreq": 30.0,
+      "peak1Freq": 200.0, "peak1Gain": 2.5, "peak1Q": 0.75,
+      "peak2Freq": 600.0, "peak2Gain": 1.0, "peak2Q": 0.9,
+      "peak3Freq": 3500.0, "peak3Gain": 3.0, "peak3Q": 1.1,
+      "peak4Freq": 8000.0, "peak4Gain": -2.0, "peak4Q": 0.8,
+      "lpfFreq": 18000.0 },
+
+    { "name": "API",
+      "saturation": 1.0, "saturationType": 2,
+      "transistorDrive": 5.0, "transistorBite": 0.7, "transistorClip": 0.3, "transistorOutput": 1.0,
+      "hpfFreq": 35.0,
+      "peak1Freq": 150.0, "peak1Gain": 2.0, "peak1Q": 0.8,
+      "peak2Freq": 750.0, "peak2Gain": 3.0, "peak2Q": 1.0,
+      "peak3Freq": 3000.0, "peak3Gain": 4.0, "peak3Q": 1.2,
+      "peak4Freq": 6000.0, "peak4Gain": 2.0, "peak4Q": 0.9,
+      "lpfFreq": 20000.0 },
+
+    { "name": "Blown Speaker",
+      "saturation": 1.0, "saturationType": 5,
+      "fuzzDrive": 9.0, "fuzzGate": 0.4, "fuzzTone": 0.2, "fuzzOutput": 0.8,
+      "hpfFreq": 80.0,
+      "peak1Freq": 200.0, "peak1Gain": -2.0, "peak1Q": 0.7,
+      "peak2Freq": 800.0, "peak2Gain": -4.0, "peak2Q": 0.8,
+      "peak3Freq": 2000.0, "peak3Gain": -3.0, "peak3Q": 0.9,
+      "peak4Freq": 5000.0, "peak4Gain": -6.0, "peak4Q": 0.7,
+      "lpfFreq": 4000.0 },
+
+    { "name": "HiFi",
+      "saturation": 1.0, "saturationType": 4,
+      "diodeDrive": 1.0, "diodeAsym": 0.5, "diodeClip": 0.2, "diodeOutput": 1.05,
+      "hpfFreq": 20.0,
+      "peak1Freq": 200.0, "peak1Gain": 1.0, "peak1Q": 0.9,
+      "peak2Freq": 1000.0, "peak2Gain": 0.5, "peak2Q": 1.0,
+      "peak3Freq": 4000.0, "peak3Gain": 2.0, "peak3Q": 1.0,
+      "peak4Freq": 8000.0, "peak4Gain": 3.0, "peak4Q": 1.1,
+      "lpfFreq": 20000.0 },
+
+    { "name": "LoFi",
+      "saturation": 1.0, "saturationType": 6,
+      "bitDepth": 6.0, "bitRate": 8.0, "bitMix": 0.9, "bitOutput": 0.85,
+      "hpfFreq": 100.0,
+      "peak1Freq": 150.0, "peak1Gain": -3.0, "peak1Q": 0.7,
+      "peak2Freq": 600.0, "peak2Gain": 5.0, "peak2Q": 0.8,
+      "peak3Freq": 2000.0, "peak3Gain": 3.0, "peak3Q": 0.9,
+      "peak4Freq": 5000.0, "peak4Gain": -5.0, "peak4Q": 0.8,
+      "lpfFreq": 3500.0 }
+  ]
+}
+)json";
+}
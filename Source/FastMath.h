@@ -0,0 +1,304 @@
+/*
+  ==============================================================================
+
+    FastMath.h
+
+    Small SIMD and fast-approximation helpers for the DSP hot loops.
+
+    Float4 wraps four floats in one register: SSE2 on x86/x64, NEON on
+    ARM64, and a plain array everywhere else, so the kernels that use it
+    compile (and give the same results) on every platform the plugin builds
+    for. Only the operations the effects chain actually needs are provided.
+
+    FastMath::tanh is a clamped [7/6] Pade approximation of tanh. Its absolute
+    error is below 1e-4 over the whole real line, which is well under the
+    noise floor of the saturators that use it. FastMath::log2 and exp2 are
+    accurate enough for gain computers working in decibels.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if defined (__SSE2__) || defined (_M_X64) || defined (_M_AMD64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define STATIC_CURRENTS_SIMD_SSE 1
+#elif defined (__aarch64__) || defined (_M_ARM64)
+ #include <arm_neon.h>
+ #define STATIC_CURRENTS_SIMD_NEON 1
+#endif
+
+namespace FastMath
+{
+
+//==============================================================================
+/** Four floats processed together. Loads and stores are unaligned. */
+struct Float4
+{
+    static constexpr int size = 4;
+
+   #if STATIC_CURRENTS_SIMD_SSE
+    __m128 v;
+
+    static Float4 load (const float* p) noexcept         { return { _mm_loadu_ps (p) }; }
+    static Float4 broadcast (float x) noexcept           { return { _mm_set1_ps (x) }; }
+    void store (float* p) const noexcept                 { _mm_storeu_ps (p, v); }
+   #elif STATIC_CURRENTS_SIMD_NEON
+    float32x4_t v;
+
+    static Float4 load (const float* p) noexcept         { return { vld1q_f32 (p) }; }
+    static Float4 broadcast (float x) noexcept           { return { vdupq_n_f32 (x) }; }
+    void store (float* p) const noexcept                 { vst1q_f32 (p, v); }
+   #else
+    float v[4];
+
+    static Float4 load (const float* p) noexcept         { return { { p[0], p[1], p[2], p[3] } }; }
+    static Float4 broadcast (float x) noexcept           { return { { x, x, x, x } }; }
+    void store (float* p) const noexcept                 { for (int i = 0; i < 4; ++i) p[i] = v[i]; }
+
+    template <typename Op>
+    static Float4 map (Float4 a, Float4 b, Op op) noexcept
+    {
+        return { { op (a.v[0], b.v[0]), op (a.v[1], b.v[1]), op (a.v[2], b.v[2]), op (a.v[3], b.v[3]) } };
+    }
+   #endif
+};
+
+//==============================================================================
+/*  The kernels are written once as templates and instantiated for both
+    float (loop tails) and Float4, so every operation exists in both forms.
+*/
+template <typename T> T broadcast (float x) noexcept;
+template <> inline float broadcast<float> (float x) noexcept     { return x; }
+template <> inline Float4 broadcast<Float4> (float x) noexcept   { return Float4::broadcast (x); }
+
+template <typename T> T load (const float* p) noexcept;
+template <> inline float load<float> (const float* p) noexcept       { return *p; }
+template <> inline Float4 load<Float4> (const float* p) noexcept     { return Float4::load (p); }
+
+inline void store (float* p, float x) noexcept      { *p = x; }
+inline void store (float* p, Float4 x) noexcept     { x.store (p); }
+
+inline float min (float a, float b) noexcept          { return juce::jmin (a, b); }
+inline float max (float a, float b) noexcept          { return juce::jmax (a, b); }
+inline float abs (float a) noexcept                   { return std::abs (a); }
+inline float copySign (float a, float b) noexcept     { return std::copysign (a, b); }  // |a| with the sign of b
+
+#if STATIC_CURRENTS_SIMD_SSE
+inline Float4 operator+ (Float4 a, Float4 b) noexcept     { return { _mm_add_ps (a.v, b.v) }; }
+inline Float4 operator- (Float4 a, Float4 b) noexcept     { return { _mm_sub_ps (a.v, b.v) }; }
+inline Float4 operator* (Float4 a, Float4 b) noexcept     { return { _mm_mul_ps (a.v, b.v) }; }
+inline Float4 operator/ (Float4 a, Float4 b) noexcept     { return { _mm_div_ps (a.v, b.v) }; }
+inline Float4 min (Float4 a, Float4 b) noexcept           { return { _mm_min_ps (a.v, b.v) }; }
+inline Float4 max (Float4 a, Float4 b) noexcept           { return { _mm_max_ps (a.v, b.v) }; }
+inline Float4 abs (Float4 a) noexcept                     { return { _mm_andnot_ps (_mm_set1_ps (-0.0f), a.v) }; }
+
+inline Float4 copySign (Float4 a, Float4 b) noexcept
+{
+    const auto signBit = _mm_set1_ps (-0.0f);
+    return { _mm_or_ps (_mm_andnot_ps (signBit, a.v), _mm_and_ps (signBit, b.v)) };
+}
+#elif STATIC_CURRENTS_SIMD_NEON
+inline Float4 operator+ (Float4 a, Float4 b) noexcept     { return { vaddq_f32 (a.v, b.v) }; }
+inline Float4 operator- (Float4 a, Float4 b) noexcept     { return { vsubq_f32 (a.v, b.v) }; }
+inline Float4 operator* (Float4 a, Float4 b) noexcept     { return { vmulq_f32 (a.v, b.v) }; }
+inline Float4 operator/ (Float4 a, Float4 b) noexcept     { return { vdivq_f32 (a.v, b.v) }; }
+inline Float4 min (Float4 a, Float4 b) noexcept           { return { vminq_f32 (a.v, b.v) }; }
+inline Float4 max (Float4 a, Float4 b) noexcept           { return { vmaxq_f32 (a.v, b.v) }; }
+inline Float4 abs (Float4 a) noexcept                     { return { vabsq_f32 (a.v) }; }
+inline Float4 copySign (Float4 a, Float4 b) noexcept      { return { vbslq_f32 (vdupq_n_u32 (0x80000000u), b.v, a.v) }; }
+#else
+inline Float4 operator+ (Float4 a, Float4 b) noexcept     { return Float4::map (a, b, [] (float x, float y) { return x + y; }); }
+inline Float4 operator- (Float4 a, Float4 b) noexcept     { return Float4::map (a, b, [] (float x, float y) { return x - y; }); }
+inline Float4 operator* (Float4 a, Float4 b) noexcept     { return Float4::map (a, b, [] (float x, float y) { return x * y; }); }
+inline Float4 operator/ (Float4 a, Float4 b) noexcept     { return Float4::map (a, b, [] (float x, float y) { return x / y; }); }
+inline Float4 min (Float4 a, Float4 b) noexcept           { return Float4::map (a, b, [] (float x, float y) { return juce::jmin (x, y); }); }
+inline Float4 max (Float4 a, Float4 b) noexcept           { return Float4::map (a, b, [] (float x, float y) { return juce::jmax (x, y); }); }
+inline Float4 abs (Float4 a) noexcept                     { return Float4::map (a, a, [] (float x, float) { return std::abs (x); }); }
+inline Float4 copySign (Float4 a, Float4 b) noexcept      { return Float4::map (a, b, [] (float x, float y) { return std::copysign (x, y); }); }
+#endif
+
+// Mixed forms, so kernels can use plain float constants with either type
+inline Float4 operator+ (Float4 a, float b) noexcept      { return a + Float4::broadcast (b); }
+inline Float4 operator- (Float4 a, float b) noexcept      { return a - Float4::broadcast (b); }
+inline Float4 operator* (Float4 a, float b) noexcept      { return a * Float4::broadcast (b); }
+inline Float4 operator+ (float a, Float4 b) noexcept      { return Float4::broadcast (a) + b; }
+inline Float4 operator- (float a, Float4 b) noexcept      { return Float4::broadcast (a) - b; }
+inline Float4 operator* (float a, Float4 b) noexcept      { return Float4::broadcast (a) * b; }
+inline Float4 operator/ (float a, Float4 b) noexcept      { return Float4::broadcast (a) / b; }
+
+/** (a > b) ? ifTrue : ifFalse, lane by lane. */
+inline float selectIfGreater (float a, float b, float ifTrue, float ifFalse) noexcept    { return a > b ? ifTrue : ifFalse; }
+
+#if STATIC_CURRENTS_SIMD_SSE
+inline Float4 selectIfGreater (Float4 a, Float4 b, Float4 ifTrue, Float4 ifFalse) noexcept
+{
+    const auto mask = _mm_cmpgt_ps (a.v, b.v);
+    return { _mm_or_ps (_mm_and_ps (mask, ifTrue.v), _mm_andnot_ps (mask, ifFalse.v)) };
+}
+#elif STATIC_CURRENTS_SIMD_NEON
+inline Float4 selectIfGreater (Float4 a, Float4 b, Float4 ifTrue, Float4 ifFalse) noexcept
+{
+    return { vbslq_f32 (vcgtq_f32 (a.v, b.v), ifTrue.v, ifFalse.v) };
+}
+#else
+inline Float4 selectIfGreater (Float4 a, Float4 b, Float4 ifTrue, Float4 ifFalse) noexcept
+{
+    return { { a.v[0] > b.v[0] ? ifTrue.v[0] : ifFalse.v[0], a.v[1] > b.v[1] ? ifTrue.v[1] : ifFalse.v[1],
+               a.v[2] > b.v[2] ? ifTrue.v[2] : ifFalse.v[2], a.v[3] > b.v[3] ? ifTrue.v[3] : ifFalse.v[3] } };
+}
+#endif
+
+template <typename T>
+inline T clamp (T x, float lo, float hi) noexcept       { return min (max (x, broadcast<T> (lo)), broadcast<T> (hi)); }
+
+/** Flushes denormals (and anything below 1e-8) to zero, lane by lane. For
+    filter state at the end of a block, not for per-sample use.
+*/
+inline Float4 snapToZero (Float4 x) noexcept
+{
+    alignas (16) float lanes[Float4::size];
+    x.store (lanes);
+
+    for (auto& v : lanes)
+        JUCE_SNAP_TO_ZERO (v);
+
+    return Float4::load (lanes);
+}
+
+/** Runs fn (Float4, i) for each whole group of four samples, then
+    fn (float, i) for the remaining ones. The first argument is only there
+    to pick the type.
+*/
+template <typename Fn>
+inline void forEachSample (int numSamples, Fn&& fn)
+{
+    int i = 0;
+
+    for (; i + Float4::size <= numSamples; i += Float4::size)
+        fn (Float4::broadcast (0.0f), i);
+
+    for (; i < numSamples; ++i)
+        fn (0.0f, i);
+}
+
+//==============================================================================
+/** Fast tanh for float or Float4. */
+template <typename T>
+inline T tanh (T x) noexcept
+{
+    x = clamp (x, -4.97f, 4.97f);   // where the approximation reaches 1
+    const T x2 = x * x;
+
+    const T num = x * (broadcast<T> (135135.0f) + x2 * (broadcast<T> (17325.0f) + x2 * (broadcast<T> (378.0f) + x2)));
+    const T den = broadcast<T> (135135.0f) + x2 * (broadcast<T> (62370.0f) + x2 * (broadcast<T> (3150.0f) + x2 * broadcast<T> (28.0f)));
+
+    return num / den;
+}
+
+//==============================================================================
+/*  log2 and exp2 split the float into exponent and mantissa bits and fit the
+    mantissa part with a polynomial. log2 is within 3e-5 of the real thing
+    (0.0002 dB when used for decibels), exp2 within 1e-5 relative.
+*/
+namespace detail
+{
+    /** log2 (1 + m) for m in [0, 1). */
+    template <typename T>
+    inline T log2OnePlus (T m) noexcept
+    {
+        return broadcast<T> (3.168154509e-05f)
+                 + m * (broadcast<T> (1.441270837f)
+                 + m * (broadcast<T> (-0.7057194842f)
+                 + m * (broadcast<T> (0.4087496684f)
+                 + m * (broadcast<T> (-0.1877439977f)
+                 + m * broadcast<T> (0.04343433452f)))));
+    }
+
+    /** 2^f for f in [0, 1). */
+    template <typename T>
+    inline T exp2Fraction (T f) noexcept
+    {
+        return broadcast<T> (1.000007251f)
+                 + f * (broadcast<T> (0.6929315710f)
+                 + f * (broadcast<T> (0.2417096419f)
+                 + f * (broadcast<T> (0.05166721675f)
+                 + f * broadcast<T> (0.01367659803f))));
+    }
+}
+
+/** Fast log2 of a positive, normal float. */
+inline float log2 (float x) noexcept
+{
+    uint32_t bits;
+    std::memcpy (&bits, &x, sizeof (bits));
+
+    const auto exponent = static_cast<float> (static_cast<int> (bits >> 23) - 127);
+    bits = (bits & 0x007fffffu) | 0x3f800000u;
+
+    float mantissa;
+    std::memcpy (&mantissa, &bits, sizeof (mantissa));
+    return exponent + detail::log2OnePlus (mantissa - 1.0f);
+}
+
+/** Fast 2^x, clamped to the normal float range. */
+inline float exp2 (float x) noexcept
+{
+    x = juce::jlimit (-126.0f, 126.0f, x);
+    const auto whole = std::floor (x);
+
+    const auto bits = static_cast<uint32_t> (static_cast<int> (whole) + 127) << 23;
+    float scale;
+    std::memcpy (&scale, &bits, sizeof (scale));
+
+    return detail::exp2Fraction (x - whole) * scale;
+}
+
+#if STATIC_CURRENTS_SIMD_SSE
+inline Float4 log2 (Float4 x) noexcept
+{
+    const auto bits = _mm_castps_si128 (x.v);
+    const Float4 exponent { _mm_cvtepi32_ps (_mm_sub_epi32 (_mm_srli_epi32 (bits, 23), _mm_set1_epi32 (127))) };
+    const Float4 mantissa { _mm_castsi128_ps (_mm_or_si128 (_mm_and_si128 (bits, _mm_set1_epi32 (0x007fffff)),
+                                                            _mm_set1_epi32 (0x3f800000))) };
+    return exponent + detail::log2OnePlus (mantissa - 1.0f);
+}
+
+inline Float4 exp2 (Float4 x) noexcept
+{
+    x = clamp (x, -126.0f, 126.0f);
+
+    // Truncate, then step down where that rounded towards zero from below
+    auto whole = _mm_cvttps_epi32 (x.v);
+    whole = _mm_add_epi32 (whole, _mm_castps_si128 (_mm_cmpgt_ps (_mm_cvtepi32_ps (whole), x.v)));
+
+    const Float4 fraction { _mm_sub_ps (x.v, _mm_cvtepi32_ps (whole)) };
+    const Float4 scale { _mm_castsi128_ps (_mm_slli_epi32 (_mm_add_epi32 (whole, _mm_set1_epi32 (127)), 23)) };
+    return detail::exp2Fraction (fraction) * scale;
+}
+#elif STATIC_CURRENTS_SIMD_NEON
+inline Float4 log2 (Float4 x) noexcept
+{
+    const auto bits = vreinterpretq_u32_f32 (x.v);
+    const Float4 exponent { vcvtq_f32_s32 (vsubq_s32 (vreinterpretq_s32_u32 (vshrq_n_u32 (bits, 23)), vdupq_n_s32 (127))) };
+    const Float4 mantissa { vreinterpretq_f32_u32 (vorrq_u32 (vandq_u32 (bits, vdupq_n_u32 (0x007fffffu)),
+                                                              vdupq_n_u32 (0x3f800000u))) };
+    return exponent + detail::log2OnePlus (mantissa - 1.0f);
+}
+
+inline Float4 exp2 (Float4 x) noexcept
+{
+    x = clamp (x, -126.0f, 126.0f);
+
+    const Float4 whole { vrndmq_f32 (x.v) };
+    const Float4 scale { vreinterpretq_f32_s32 (vshlq_n_s32 (vaddq_s32 (vcvtq_s32_f32 (whole.v), vdupq_n_s32 (127)), 23)) };
+    return detail::exp2Fraction (x - whole) * scale;
+}
+#else
+inline Float4 log2 (Float4 x) noexcept    { return { { log2 (x.v[0]), log2 (x.v[1]), log2 (x.v[2]), log2 (x.v[3]) } }; }
+inline Float4 exp2 (Float4 x) noexcept    { return { { exp2 (x.v[0]), exp2 (x.v[1]), exp2 (x.v[2]), exp2 (x.v[3]) } }; }
+#endif
+
+} // namespace FastMath
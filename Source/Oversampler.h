@@ -0,0 +1,589 @@
+/*
+  ==============================================================================
+
+    Oversampler.h
+
+    Polyphase half-band oversampling, 1x/2x/4x/8x, for the saturators.
+
+    Each doubling is one half-band stage, so 8x is three 2x stages in a row
+    with the steepest filter at the base rate, where the audio band ends,
+    and short ones above it, where there is plenty of room to roll off.
+    Every stage runs in polyphase form: upsampling never multiplies the
+    zeros it stuffs in, and downsampling never computes the samples it
+    throws away.
+
+    Two filter types:
+
+    - Minimum phase: polyphase IIR half-bands built from two chains of
+      first-order allpass sections (Valenzuela & Constantinides). A handful
+      of multiplies per sample, ~100 dB of image rejection, a few samples of
+      (frequency-dependent) delay. The default.
+
+    - Linear phase: Kaiser-windowed half-band FIRs. Every second tap is zero
+      and the centre tap is 0.5, so a 127-tap filter costs 64 multiplies.
+      No phase distortion, at the price of ~64 samples of latency, which is
+      padded to a whole number of samples so the host can compensate it
+      exactly.
+
+    Up to four channels share each pass in the lanes of a Float4, as in
+    BiquadCascade. All memory is allocated in prepare(); setFactor() and
+    setMode() are realtime safe.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FastMath.h"
+
+//==============================================================================
+class Oversampler
+{
+public:
+    enum class Mode { minimumPhase, linearPhase };
+
+    static constexpr int maxFactor = 8;
+
+    Oversampler() = default;
+    ~Oversampler() = default;
+
+    //==============================================================================
+    void prepare (double sampleRate, int samplesPerBlock, int numChannels)
+    {
+        juce::ignoreUnused (sampleRate);
+
+        maxBlockSize = juce::jmax (1, samplesPerBlock);
+        numPreparedChannels = juce::jmax (1, numChannels);
+        const int numGroups = (numPreparedChannels + lanes - 1) / lanes;
+
+        for (int s = 0; s < maxStages; ++s)
+        {
+            // The base-rate stage has to be steep; the ones above it only
+            // need to clear the images of an already band-limited signal
+            const bool first = (s == 0);
+
+            stages[s].fir.prepare (first ? 31 : 7, numGroups);
+            stages[s].iir.prepare (first ? 8 : 4, first ? 0.0406 : 0.2, numGroups);
+
+            buffers[s].setSize (numPreparedChannels, maxBlockSize << (s + 1));
+        }
+
+        // Enough padding for any linear-phase latency to round up to whole samples
+        padding.setSize (numPreparedChannels, maxFactor);
+
+        updateLatency();
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& stage : stages)
+        {
+            stage.fir.reset();
+            stage.iir.reset();
+        }
+
+        for (auto& buffer : buffers)
+            buffer.clear();
+
+        padding.clear();
+        paddingPosition = 0;
+    }
+
+    /** 1, 2, 4 or 8 (anything else is rounded down to one of those).
+        Changing it clears the filter state.
+    */
+    void setFactor (int newFactor)
+    {
+        int stagesNeeded = 0;
+
+        while (stagesNeeded < maxStages && (2 << stagesNeeded) <= newFactor)
+            ++stagesNeeded;
+
+        if (stagesNeeded != numStages)
+        {
+            numStages = stagesNeeded;
+            updateLatency();
+            reset();
+        }
+    }
+
+    void setMode (Mode newMode)
+    {
+        if (newMode != mode)
+        {
+            mode = newMode;
+            updateLatency();
+            reset();
+        }
+    }
+
+    int getFactor() const noexcept      { return 1 << numStages; }
+    Mode getMode() const noexcept       { return mode; }
+
+    /** The round-trip (up then down) delay at the base rate. Exact in
+        linear-phase mode; the low-frequency group delay, rounded, in
+        minimum-phase mode.
+    */
+    int getLatencySamples() const noexcept  { return latency; }
+
+    //==============================================================================
+    /** Upsamples the block, returning a view of the oversampled signal
+        (getFactor() times as many samples) to process in place. Pass it back
+        to processDown() before the next call.
+    */
+    juce::AudioBuffer<float> processUp (const juce::AudioBuffer<float>& input)
+    {
+        const int numChannels = juce::jmin (input.getNumChannels(), numPreparedChannels);
+        const int numSamples = input.getNumSamples();
+        jassert (input.getNumChannels() <= numPreparedChannels && numSamples <= maxBlockSize);
+
+        if (numStages == 0)
+            return juce::AudioBuffer<float> (const_cast<float* const*> (input.getArrayOfReadPointers()), numChannels, numSamples);
+
+        const float* const* source = input.getArrayOfReadPointers();
+        int numIn = numSamples;
+
+        for (int s = 0; s < numStages; ++s)
+        {
+            auto* const* dest = buffers[s].getArrayOfWritePointers();
+
+            forEachGroup (numChannels, [&] (int group, int firstChannel, int numLanes)
+            {
+                if (mode == Mode::linearPhase)
+                    stages[s].fir.upsample (source + firstChannel, dest + firstChannel, numLanes, numIn, group);
+                else
+                    stages[s].iir.upsample (source + firstChannel, dest + firstChannel, numLanes, numIn, group);
+            });
+
+            source = buffers[s].getArrayOfReadPointers();
+            numIn *= 2;
+        }
+
+        return juce::AudioBuffer<float> (buffers[numStages - 1].getArrayOfWritePointers(), numChannels, numIn);
+    }
+
+    /** Downsamples the signal returned by processUp() into output, which must
+        have the same size as the block that went in.
+    */
+    void processDown (juce::AudioBuffer<float>& output)
+    {
+        if (numStages == 0)
+            return;
+
+        const int numChannels = juce::jmin (output.getNumChannels(), numPreparedChannels);
+        int numOut = output.getNumSamples() << (numStages - 1);
+
+        if (mode == Mode::linearPhase)
+            applyPadding (buffers[numStages - 1], numChannels, numOut * 2);
+
+        for (int s = numStages; --s >= 0;)
+        {
+            const float* const* source = buffers[s].getArrayOfReadPointers();
+            auto* const* dest = (s == 0) ? output.getArrayOfWritePointers() : buffers[s - 1].getArrayOfWritePointers();
+
+            forEachGroup (numChannels, [&] (int group, int firstChannel, int numLanes)
+            {
+                if (mode == Mode::linearPhase)
+                    stages[s].fir.downsample (source + firstChannel, dest + firstChannel, numLanes, numOut, group);
+                else
+                    stages[s].iir.downsample (source + firstChannel, dest + firstChannel, numLanes, numOut, group);
+            });
+
+            numOut /= 2;
+        }
+    }
+
+private:
+    using Float4 = FastMath::Float4;
+    static constexpr int lanes = Float4::size;
+    static constexpr int maxStages = 3;
+
+    //==============================================================================
+    /** Four channels of one sample, gathered from / scattered to planar buffers. */
+    static Float4 gather (const float* const* channels, int numLanes, int index) noexcept
+    {
+        alignas (16) float frame[lanes] = {};
+
+        for (int ch = 0; ch < numLanes; ++ch)
+            frame[ch] = channels[ch][index];
+
+        return Float4::load (frame);
+    }
+
+    static void scatter (Float4 x, float* const* channels, int numLanes, int index) noexcept
+    {
+        alignas (16) float frame[lanes];
+        x.store (frame);
+
+        for (int ch = 0; ch < numLanes; ++ch)
+            channels[ch][index] = frame[ch];
+    }
+
+    template <typename Fn>
+    static void forEachGroup (int numChannels, Fn&& fn)
+    {
+        for (int group = 0, first = 0; first < numChannels; ++group, first += lanes)
+            fn (group, first, juce::jmin (lanes, numChannels - first));
+    }
+
+    //==============================================================================
+    /** The last few frames, newest first, as one contiguous array: every
+        frame is written twice, half a buffer apart, so the window never
+        wraps.
+    */
+    struct FrameHistory
+    {
+        void prepare (int length)
+        {
+            size = length;
+            frames.assign (static_cast<size_t> (2 * length), Float4::broadcast (0.0f));
+            position = 0;
+        }
+
+        void reset() noexcept
+        {
+            std::fill (frames.begin(), frames.end(), Float4::broadcast (0.0f));
+            position = 0;
+        }
+
+        void push (Float4 x) noexcept
+        {
+            position = (position == 0 ? size : position) - 1;
+            frames[static_cast<size_t> (position)] = x;
+            frames[static_cast<size_t> (position + size)] = x;
+        }
+
+        /** window()[j] is the frame pushed j pushes ago. */
+        const Float4* window() const noexcept     { return frames.data() + position; }
+
+        std::vector<Float4> frames;
+        int size = 0, position = 0;
+    };
+
+    //==============================================================================
+    /** Linear-phase half-band FIR of 4 * halfOrder + 3 taps. Only the even
+        taps (stored as phaseTaps, scaled by two) and the 0.5 centre tap are
+        non-zero, so each polyphase branch is either a short FIR or a pure
+        delay of halfOrder samples.
+    */
+    struct HalfBandFIR
+    {
+        void prepare (int newHalfOrder, int numGroups)
+        {
+            halfOrder = newHalfOrder;
+            const int numPhaseTaps = 2 * halfOrder + 2;
+            const int centre = 2 * halfOrder + 1;
+
+            // Kaiser window for ~90 dB of stopband attenuation
+            const double beta = 0.1102 * (90.0 - 8.7);
+            phaseTaps.resize (static_cast<size_t> (numPhaseTaps));
+            double sum = 0.0;
+
+            for (int j = 0; j < numPhaseTaps; ++j)
+            {
+                const int offset = 2 * j - centre;   // always odd
+                const double sinc = std::sin (juce::MathConstants<double>::halfPi * offset) / (juce::MathConstants<double>::pi * offset);
+                const double r = static_cast<double> (offset) / centre;
+                const double tap = 2.0 * sinc * besselI0 (beta * std::sqrt (1.0 - r * r)) / besselI0 (beta);
+
+                phaseTaps[static_cast<size_t> (j)] = static_cast<float> (tap);
+                sum += tap;
+            }
+
+            // Exactly unity gain at DC
+            for (auto& tap : phaseTaps)
+                tap = static_cast<float> (tap / sum);
+
+            groups.resize (static_cast<size_t> (numGroups));
+
+            for (auto& g : groups)
+            {
+                g.input.prepare (numPhaseTaps);
+                g.even.prepare (numPhaseTaps);
+                g.odd.prepare (halfOrder + 2);
+            }
+        }
+
+        void reset() noexcept
+        {
+            for (auto& g : groups)
+            {
+                g.input.reset();
+                g.even.reset();
+                g.odd.reset();
+            }
+        }
+
+        /** Round-trip delay in samples at this stage's input rate. */
+        int getLatency() const noexcept     { return 2 * halfOrder + 1; }
+
+        void upsample (const float* const* in, float* const* out, int numLanes, int numIn, int group) noexcept
+        {
+            auto& history = groups[static_cast<size_t> (group)].input;
+
+            for (int i = 0; i < numIn; ++i)
+            {
+                history.push (gather (in, numLanes, i));
+                const auto* w = history.window();
+
+                scatter (convolve (w), out, numLanes, 2 * i);
+                scatter (w[halfOrder], out, numLanes, 2 * i + 1);
+            }
+        }
+
+        void downsample (const float* const* in, float* const* out, int numLanes, int numOut, int group) noexcept
+        {
+            auto& g = groups[static_cast<size_t> (group)];
+
+            for (int i = 0; i < numOut; ++i)
+            {
+                g.even.push (gather (in, numLanes, 2 * i));
+                g.odd.push (gather (in, numLanes, 2 * i + 1));
+
+                scatter ((convolve (g.even.window()) + g.odd.window()[halfOrder + 1]) * 0.5f, out, numLanes, i);
+            }
+        }
+
+        Float4 convolve (const Float4* window) const noexcept
+        {
+            auto acc = Float4::broadcast (0.0f);
+
+            for (size_t j = 0; j < phaseTaps.size(); ++j)
+                acc = acc + window[j] * phaseTaps[j];
+
+            return acc;
+        }
+
+        static double besselI0 (double x) noexcept
+        {
+            double sum = 1.0, term = 1.0;
+
+            for (int k = 1; k < 50 && term > sum * 1.0e-12; ++k)
+            {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }
+
+            return sum;
+        }
+
+        struct GroupState
+        {
+            FrameHistory input, even, odd;
+        };
+
+        int halfOrder = 0;
+        std::vector<float> phaseTaps;
+        std::vector<GroupState> groups;
+    };
+
+    //==============================================================================
+    /** Minimum-phase polyphase IIR half-band: H(z) = (A0(z^2) + z^-1 A1(z^2)) / 2,
+        where A0 and A1 are chains of first-order allpass sections that run at
+        the lower rate. Coefficients alternate between the two chains.
+    */
+    struct HalfBandIIR
+    {
+        static constexpr int maxCoefficients = 8;
+
+        void prepare (int newNumCoefficients, double transitionBandwidth, int numGroups)
+        {
+            numCoefficients = juce::jmin (newNumCoefficients, maxCoefficients);
+            designCoefficients (transitionBandwidth);
+
+            groups.resize (static_cast<size_t> (numGroups));
+        }
+
+        void reset() noexcept
+        {
+            for (auto& g : groups)
+                g = {};
+        }
+
+        /** Round-trip delay at DC, in samples at this stage's input rate. Each
+            allpass section adds 2 (1 - c) / (1 + c) samples at the higher
+            rate. Each filter pass delays by the average of the two chains plus
+            half a sample; the downsampler's output is taken on the odd sample,
+            which takes one high-rate sample back off the round trip.
+        */
+        double getLatency() const noexcept
+        {
+            double delay[2] = {};
+
+            for (int i = 0; i < numCoefficients; ++i)
+                delay[i % 2] += 2.0 * (1.0 - coefficients[i]) / (1.0 + coefficients[i]);
+
+            return (delay[0] + delay[1]) * 0.5;
+        }
+
+        void upsample (const float* const* in, float* const* out, int numLanes, int numIn, int group) noexcept
+        {
+            auto& g = groups[static_cast<size_t> (group)];
+
+            for (int i = 0; i < numIn; ++i)
+            {
+                const auto x = gather (in, numLanes, i);
+                Float4 paths[2] = { x, x };
+                runAllpasses (paths, g.up);
+
+                scatter (paths[0], out, numLanes, 2 * i);
+                scatter (paths[1], out, numLanes, 2 * i + 1);
+            }
+
+            snapToZero (g.up);
+        }
+
+        void downsample (const float* const* in, float* const* out, int numLanes, int numOut, int group) noexcept
+        {
+            auto& g = groups[static_cast<size_t> (group)];
+
+            for (int i = 0; i < numOut; ++i)
+            {
+                Float4 paths[2] = { gather (in, numLanes, 2 * i + 1), gather (in, numLanes, 2 * i) };
+                runAllpasses (paths, g.down);
+
+                scatter ((paths[0] + paths[1]) * 0.5f, out, numLanes, i);
+            }
+
+            snapToZero (g.down);
+        }
+
+        struct AllpassState
+        {
+            Float4 x[maxCoefficients] = {}, y[maxCoefficients] = {};
+        };
+
+        /** The upsampler and downsampler are separate filters. */
+        struct GroupState
+        {
+            AllpassState up, down;
+        };
+
+        void runAllpasses (Float4 (&paths)[2], AllpassState& g) const noexcept
+        {
+            for (int i = 0; i < numCoefficients; ++i)
+            {
+                auto& p = paths[i % 2];
+                const auto previousInput = g.x[i];
+                g.x[i] = p;
+                p = (p - g.y[i]) * coefficients[i] + previousInput;
+                g.y[i] = p;
+            }
+        }
+
+        void snapToZero (AllpassState& g) const noexcept
+        {
+            for (int i = 0; i < numCoefficients; ++i)
+                g.y[i] = FastMath::snapToZero (g.y[i]);
+        }
+
+        /** Elliptic half-band design for the given number of coefficients and
+            transition bandwidth (relative to the higher rate), after Laurent
+            de Soras' HIIR.
+        */
+        void designCoefficients (double transition) noexcept
+        {
+            const double k = std::pow (std::tan ((1.0 - 2.0 * transition) * juce::MathConstants<double>::pi / 4.0), 2.0);
+            const double kRoot = std::pow (1.0 - k * k, 0.25);
+            const double e = 0.5 * (1.0 - kRoot) / (1.0 + kRoot);
+            const double e4 = e * e * e * e;
+            const double q = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+            const int order = 2 * numCoefficients + 1;
+
+            for (int index = 0; index < numCoefficients; ++index)
+            {
+                const double c = index + 1.0;
+                double numerator = 0.0, denominator = 0.0;
+
+                for (int i = 0; i < 20; ++i)
+                    numerator += ((i % 2) == 0 ? 1.0 : -1.0) * std::pow (q, i * (i + 1))
+                                   * std::sin ((2 * i + 1) * c * juce::MathConstants<double>::pi / order);
+
+                for (int i = 1; i < 20; ++i)
+                    denominator += ((i % 2) == 1 ? -1.0 : 1.0) * std::pow (q, i * i)
+                                     * std::cos (2 * i * c * juce::MathConstants<double>::pi / order);
+
+                const double w = numerator * std::pow (q, 0.25) / (denominator + 0.5);
+                const double w2 = w * w;
+                const double x = std::sqrt ((1.0 - w2 * k) * (1.0 - w2 / k)) / (1.0 + w2);
+
+                coefficients[index] = static_cast<float> ((1.0 - x) / (1.0 + x));
+            }
+        }
+
+        int numCoefficients = 0;
+        float coefficients[maxCoefficients] = {};
+        std::vector<GroupState> groups;
+    };
+
+    //==============================================================================
+    struct Stage
+    {
+        HalfBandFIR fir;
+        HalfBandIIR iir;
+    };
+
+    void updateLatency()
+    {
+        // Stage s runs at 2^s times the base rate, so its delay counts 2^-s
+        double total = 0.0;
+
+        for (int s = 0; s < numStages; ++s)
+            total += (mode == Mode::linearPhase ? stages[s].fir.getLatency() : stages[s].iir.getLatency())
+                       / static_cast<double> (1 << s);
+
+        latency = static_cast<int> (std::ceil (total - 1.0e-9));
+
+        if (mode == Mode::linearPhase)
+        {
+            // Round up to whole base-rate samples with a short delay at the top
+            // rate, where (latency - total) is a whole number of samples
+            numPaddingSamples = juce::roundToInt ((latency - total) * getFactor());
+        }
+        else
+        {
+            latency = juce::roundToInt (total);
+            numPaddingSamples = 0;
+        }
+    }
+
+    /** Delays the top-rate signal by numPaddingSamples. */
+    void applyPadding (juce::AudioBuffer<float>& buffer, int numChannels, int numSamples) noexcept
+    {
+        if (numPaddingSamples == 0)
+            return;
+
+        int position = paddingPosition;
+
+        for (int done = 0; done < numSamples;)
+        {
+            const int num = juce::jmin (numSamples - done, numPaddingSamples - position);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* data = buffer.getWritePointer (ch, done);
+                std::swap_ranges (data, data + num, padding.getWritePointer (ch, position));
+            }
+
+            done += num;
+            position = (position + num) % numPaddingSamples;
+        }
+
+        paddingPosition = position;
+    }
+
+    //==============================================================================
+    Stage stages[maxStages];
+    juce::AudioBuffer<float> buffers[maxStages];     // the signal at 2x, 4x and 8x
+    juce::AudioBuffer<float> padding;
+    int paddingPosition = 0, numPaddingSamples = 0;
+
+    Mode mode = Mode::minimumPhase;
+    int numStages = 1;
+    int latency = 0;
+    int maxBlockSize = 512, numPreparedChannels = 2;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Oversampler)
+};
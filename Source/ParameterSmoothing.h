@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    ParameterSmoothing.h
+
+    Per-sample parameter ramps for the effects chain's stages.
+
+    Parameters reach the chain once per block as a ChainParameters snapshot
+    of plain floats, so the audio thread never reads an atomic per sample.
+    Automation is smoothed in two layers:
+
+    - EffectsChain::smoothParameters() glides every continuous parameter of
+      the snapshot towards its new value over a short, fixed time, a block
+      at a time. A parameter that isn't moving costs one comparison.
+
+    - Within a block, each stage interpolates from the value it used last
+      block to the smoothed one with a BlockRamp: per sample for gains,
+      mixes, drive and the compressor's threshold and makeup, or by ramping
+      filter coefficients (EQ, tube filters). A ramp that doesn't move
+      reports isRamping() == false, and stages skip the ramp work.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FastMath.h"
+
+//==============================================================================
+/** A linear ramp across one block. Sample i gets start + step * (i + 1), so
+    start is the value before the block and the last sample lands on end.
+*/
+struct BlockRamp
+{
+    float start = 0.0f, step = 0.0f, end = 0.0f;
+
+    static BlockRamp between (float previous, float target, int numSamples) noexcept
+    {
+        if (previous == target || numSamples <= 0)
+            return { target, 0.0f, target };
+
+        return { previous, (target - previous) / static_cast<float> (numSamples), target };
+    }
+
+    bool isRamping() const noexcept     { return step != 0.0f; }
+
+    /** The value for sample index (float), or for the four samples from
+        index on (Float4).
+    */
+    template <typename T>
+    T at (int index) const noexcept;
+
+    /** Multiplies the buffer by the ramp. */
+    void applyGain (juce::AudioBuffer<float>& buffer) const noexcept
+    {
+        if (isRamping())
+            buffer.applyGainRamp (0, buffer.getNumSamples(), start + step, end + step);
+        else
+            buffer.applyGain (end);
+    }
+};
+
+template <>
+inline float BlockRamp::at<float> (int index) const noexcept
+{
+    return start + step * static_cast<float> (index + 1);
+}
+
+template <>
+inline FastMath::Float4 BlockRamp::at<FastMath::Float4> (int index) const noexcept
+{
+    alignas (16) static constexpr float offsets[] { 0.0f, 1.0f, 2.0f, 3.0f };
+    return FastMath::Float4::broadcast (at<float> (index)) + FastMath::Float4::load (offsets) * step;
+}
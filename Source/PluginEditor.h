@@ -17,8 +17,8 @@
 class ClickToResetListener : public juce::MouseListener
 {
 public:
-    ClickToResetListener(juce::Slider& slider, double defaultValue)
-        : sliderRef(slider), defaultVal(defaultValue) {}
+    ClickToResetListener(juce::Slider& slider, double defaultValue, juce::RangedAudioParameter& parameter)
+        : sliderRef(slider), defaultVal(defaultValue), parameterRef(parameter) {}
     
     void mouseDown(const juce::MouseEvent& event) override
     {
@@ -33,13 +33,17 @@ public:
         // If mouse moved less than 3 pixels, treat it as a click (not a drag)
         if (distance < 3.0f)
         {
+            // The slider's own gesture has ended by now, so the reset gets its own
+            parameterRef.beginChangeGesture();
             sliderRef.setValue(defaultVal, juce::sendNotificationSync);
+            parameterRef.endChangeGesture();
         }
     }
     
 private:
     juce::Slider& sliderRef;
     double defaultVal;
+    juce::RangedAudioParameter& parameterRef;
     juce::Point<int> mouseDownPos;
 };
 
@@ -60,8 +64,9 @@ public:
 private:
     void timerCallback() override;
     void updateRecordButton();
+    void updateExportStatus();
     void updateEQVisualization();
-    void syncSlidersFromParameters();
+    void refreshProfileBox();
     bool isEffectVersion() const;  // Check if running as audio effect
     
     // This reference is provided as a quick way for your editor to
@@ -88,6 +93,8 @@ private:
     juce::Rectangle<int> logoImageBounds;
     
     bool isPlaying = false;
+    bool exportInProgress = false;
+    bool batchExportInProgress = false;
     bool isEffect = false;  // Whether this is the effect version or instrument
     
     std::unique_ptr<juce::FileChooser> fileChooser;
@@ -99,6 +106,7 @@ private:
     juce::ComboBox profileBox;
       bool profileInitialized = false;
     juce::Label profileLabel { {}, "Profile" };
+    juce::TextButton compareButton { "A" }, savePresetButton { "Save" };
     
     
     // 6-Band Parametric EQ
@@ -109,6 +117,7 @@ private:
 
     // Saturation controls (replace EQ sliders section)
     juce::Label saturationSectionLabel { {}, "Saturation" };
+    juce::ComboBox oversamplingBox, oversamplingModeBox;
 
     juce::Label tubeLabel { {}, "Tube" };
     juce::Slider tubeDriveSlider, tubeWarmthSlider, tubeBiasSlider, tubeOutputSlider;
@@ -160,10 +169,11 @@ private:
     juce::Label lpfFreqLabel { {}, "Freq" }, lpfSlopeLabel { {}, "Slope" };
     
     // Compressor
-    juce::Slider compThreshSlider, compRatioSlider, compAttackSlider, compReleaseSlider, compMakeupSlider;
+    juce::Slider compThreshSlider, compRatioSlider, compAttackSlider, compReleaseSlider, compMakeupSlider, compLookaheadSlider;
     juce::Label compLabel { {}, "Dynamics + Output" };
     juce::Label compThreshLabel { {}, "Thresh" }, compRatioLabel { {}, "Ratio" };
     juce::Label compAttackLabel { {}, "Attack" }, compReleaseLabel { {}, "Release" }, compMakeupLabel { {}, "Makeup" };
+    juce::Label compLookaheadLabel { {}, "Lookahead" };
 
     juce::Rectangle<int> topSectionBounds;
     juce::Rectangle<int> eqSectionBounds;
@@ -175,5 +185,11 @@ private:
     // Click-to-reset listeners for all sliders
     std::vector<std::unique_ptr<ClickToResetListener>> clickResetListeners;
 
+    // Keep the controls and their parameters in step, both ways. Declared
+    // last so they detach before the controls are destroyed.
+    std::vector<std::unique_ptr<juce::SliderParameterAttachment>> sliderAttachments;
+    std::vector<std::unique_ptr<juce::ComboBoxParameterAttachment>> comboBoxAttachments;
+    std::unique_ptr<juce::ButtonParameterAttachment> bypassAttachment;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StaticCurrentsPluginAudioProcessorEditor)
 };
@@ -77,11 +77,10 @@ StaticCurrentsPluginAudioProcessorEditor::StaticCurrentsPluginAudioProcessorEdit
     {
         if (audioProcessor.isRecording())
         {
+            // The take is written and loaded in the background;
+            // updateRecordButton() reports the result once it lands
             audioProcessor.stopRecording();
-            if (audioProcessor.hasLoadedSample())
-                fileLabel.setText ("Recorded sample loaded", juce::dontSendNotification);
-            else
-                fileLabel.setText ("No sample recorded", juce::dontSendNotification);
+            fileLabel.setText ("Finalizing recording...", juce::dontSendNotification);
         }
         else
         {
@@ -100,15 +99,14 @@ StaticCurrentsPluginAudioProcessorEditor::StaticCurrentsPluginAudioProcessorEdit
     // Setup bypass button (instrument/standalone only)
     if (!isEffect) {
         addAndMakeVisible (bypassButton);
-        bypassButton.onClick = [this]
+        bypassButton.setClickingTogglesState (true);
+        bypassButton.setColour (juce::TextButton::buttonOnColourId, juce::Colours::orange);
+        bypassButton.onStateChange = [this]
         {
-            bool bypassed = !(*audioProcessor.getBypassParameter());
-            *audioProcessor.getBypassParameter() = bypassed;
-            bypassButton.setButtonText (bypassed ? "Bypass (ON)" : "Bypass");
-            bypassButton.setColour (juce::TextButton::buttonColourId,
-                                    bypassed ? juce::Colours::orange
-                                             : getLookAndFeel().findColour (juce::TextButton::buttonColourId));
+            bypassButton.setButtonText (bypassButton.getToggleState() ? "Bypass (ON)" : "Bypass");
         };
+        bypassAttachment = std::make_unique<juce::ButtonParameterAttachment> (
+            audioProcessor.getBypassParameterHandle()->getParameter(), bypassButton);
     }
 
     // Setup play button (instrument/standalone only)
@@ -344,6 +342,14 @@ StaticCurrentsPluginAudioProcessorEditor::StaticCurrentsPluginAudioProcessorEdit
         addAndMakeVisible (exportButton);
     exportButton.onClick = [this]
     {
+        // A second click while exporting cancels the running export
+        if (audioProcessor.isExporting() || audioProcessor.isBatchExporting())
+        {
+            audioProcessor.cancelExport();
+            audioProcessor.cancelBatchExport();
+            return;
+        }
+
         juce::PopupMenu formatMenu;
         formatMenu.addItem (1, "WAV (24-bit)");
         formatMenu.addItem (2, "WAV (16-bit)");
@@ -351,11 +357,52 @@ StaticCurrentsPluginAudioProcessorEditor::StaticCurrentsPluginAudioProcessorEdit
         formatMenu.addItem (4, "OGG Vorbis");
         formatMenu.addItem (5, "FLAC");
 
+        // Batch: process every file in a folder with the current settings
+        juce::PopupMenu batchMenu;
+        batchMenu.addItem (11, "WAV (24-bit)");
+        batchMenu.addItem (13, "MP3");
+        batchMenu.addItem (14, "OGG Vorbis");
+        batchMenu.addItem (15, "FLAC");
+        formatMenu.addSeparator();
+        formatMenu.addSubMenu ("Batch Export Folder", batchMenu);
+
         formatMenu.showMenuAsync (juce::PopupMenu::Options(), [this] (int result)
         {
             if (result == 0)
                 return;
 
+            if (result > 10)
+            {
+                const juce::String batchExtension = result == 13 ? ".mp3"
+                                                  : result == 14 ? ".ogg"
+                                                  : result == 15 ? ".flac"
+                                                                 : ".wav";
+
+                fileChooser = std::make_unique<juce::FileChooser> ("Choose a folder of samples to process...",
+                                                                    juce::File::getSpecialLocation (juce::File::userDocumentsDirectory));
+
+                fileChooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectDirectories,
+                                          [this, batchExtension] (const juce::FileChooser& chooser)
+                {
+                    auto folder = chooser.getResult();
+                    if (folder.isDirectory())
+                    {
+                        const int numFiles = audioProcessor.startBatchExport (folder, batchExtension);
+
+                        if (numFiles > 0)
+                        {
+                            batchExportInProgress = true;
+                            updateExportStatus();
+                        }
+                        else
+                        {
+                            fileLabel.setText ("No audio files to export", juce::dontSendNotification);
+                        }
+                    }
+                });
+                return;
+            }
+
             juce::String extension;
             switch (result)
             {
@@ -379,7 +426,11 @@ StaticCurrentsPluginAudioProcessorEditor::StaticCurrentsPluginAudioProcessorEdit
                     if (!file.hasFileExtension (extension))
                         file = file.withFileExtension (extension);
 
-                    audioProcessor.exportProcessedSample (file);
+                    if (audioProcessor.exportProcessedSample (file))
+                    {
+                        exportInProgress = true;
+                        updateExportStatus();
+                    }
                 }
             });
         });
@@ -405,39 +456,85 @@ StaticCurrentsPluginAudioProcessorEditor::StaticCurrentsPluginAudioProcessorEdit
         progressSlider.onDragEnd = nullptr;
     }  // Close if (!isEffect) for progressSlider
 
+    // Sliders follow their parameters through attachments, which also
+    // wrap each drag in a change gesture for the host. The text boxes keep
+    // the editor's own number format rather than the parameter's text.
+    auto attachSlider = [this] (juce::Slider& slider, ParameterHandle* param, int decimalPlaces)
+    {
+        sliderAttachments.push_back (std::make_unique<juce::SliderParameterAttachment> (param->getParameter(), slider));
+        slider.textFromValueFunction = nullptr;
+        slider.valueFromTextFunction = nullptr;
+        slider.setNumDecimalPlacesToDisplay (decimalPlaces);
+    };
+
     // Basic parameters
     addAndMakeVisible (gainSectionLabel);
     addAndMakeVisible (gainSlider);
     addAndMakeVisible (gainLabel);
     gainSlider.setSliderStyle (juce::Slider::RotaryVerticalDrag);
     gainSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 60, 16);
-    gainSlider.setRange (0.0, 1.0, 0.01);
-    gainSlider.setValue (0.7);
-    gainSlider.onValueChange = [this] { *audioProcessor.getGainParameter() = static_cast<float> (gainSlider.getValue()); };
+    attachSlider (gainSlider, audioProcessor.getGainParameter(), 2);
 
     addAndMakeVisible (pitchSlider);
     addAndMakeVisible (pitchLabel);
     pitchSlider.setSliderStyle (juce::Slider::RotaryVerticalDrag);
     pitchSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 60, 16);
-    pitchSlider.setRange (0.5, 2.0, 0.01);
-    pitchSlider.setValue (1.0);
     pitchSlider.setTextValueSuffix (" x");
-    pitchSlider.onValueChange = [this] { *audioProcessor.getPitchParameter() = static_cast<float> (pitchSlider.getValue()); };
+    attachSlider (pitchSlider, audioProcessor.getPitchParameter(), 2);
 
     // Global Output Slider
     addAndMakeVisible (globalOutputSlider);
     addAndMakeVisible (globalOutputLabel);
     globalOutputSlider.setSliderStyle (juce::Slider::RotaryVerticalDrag);
     globalOutputSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 60, 16);
-    globalOutputSlider.setRange (-24.0, 6.0, 0.1);
-    globalOutputSlider.setValue (0.0);
     globalOutputSlider.setTextValueSuffix (" dB");
-    globalOutputSlider.onValueChange = [this] { *audioProcessor.getGlobalOutputParameter() = static_cast<float> (globalOutputSlider.getValue()); };
+    attachSlider (globalOutputSlider, audioProcessor.getGlobalOutputParameter(), 1);
 
     // Profile selector (items are initialized on first resized)
     addAndMakeVisible (profileBox);
     addAndMakeVisible (profileLabel);
 
+    // A/B comparison - each slot keeps its own settings
+    addAndMakeVisible (compareButton);
+    compareButton.onClick = [this]
+    {
+        audioProcessor.selectComparisonSlot (1 - audioProcessor.getComparisonSlot());
+        compareButton.setButtonText (audioProcessor.getComparisonSlot() == 0 ? "A" : "B");
+        profileBox.setSelectedId (juce::roundToInt (audioProcessor.getProfileParameter()->load()) + 1,
+                                  juce::dontSendNotification);
+        updateEQVisualization();
+    };
+
+    // Save the current settings as a user preset
+    addAndMakeVisible (savePresetButton);
+    savePresetButton.onClick = [this]
+    {
+        auto* window = new juce::AlertWindow ("Save Preset", "Name of the user preset:", juce::AlertWindow::NoIcon);
+        window->addTextEditor ("name", profileBox.getText());
+        window->addButton ("Save", 1, juce::KeyPress (juce::KeyPress::returnKey));
+        window->addButton ("Cancel", 0, juce::KeyPress (juce::KeyPress::escapeKey));
+
+        juce::Component::SafePointer<StaticCurrentsPluginAudioProcessorEditor> editor (this);
+
+        window->enterModalState (true, juce::ModalCallbackFunction::create ([editor, window] (int result)
+        {
+            if (result != 1 || editor == nullptr)
+                return;
+
+            const int index = editor->audioProcessor.saveUserPreset (window->getTextEditorContents ("name"));
+
+            if (index < 0)
+            {
+                juce::AlertWindow::showMessageBoxAsync (juce::AlertWindow::WarningIcon,
+                                                         "Preset Not Saved",
+                                                         "The preset needs a name, and the preset folder must be writable.");
+                return;
+            }
+
+            editor->refreshProfileBox();
+        }), true);
+    };
+
     // EQ visualization
     addAndMakeVisible (eqLabel);
     addAndMakeVisible (eqVisualization);
@@ -445,6 +542,34 @@ StaticCurrentsPluginAudioProcessorEditor::StaticCurrentsPluginAudioProcessorEdit
     addAndMakeVisible (eqParamsLabel);
     eqParamsLabel.setText ("Gain / Pitch + Comp", juce::dontSendNotification);
 
+    // The parameters a band's handle moves
+    auto getBandParameters = [this] (int bandIndex) -> juce::Array<ParameterHandle*>
+    {
+        switch (bandIndex)
+        {
+            case 0:  return { audioProcessor.getHPFFreqParameter() };
+            case 1:  return { audioProcessor.getPeak1FreqParameter(), audioProcessor.getPeak1GainParameter() };
+            case 2:  return { audioProcessor.getPeak2FreqParameter(), audioProcessor.getPeak2GainParameter() };
+            case 3:  return { audioProcessor.getPeak3FreqParameter(), audioProcessor.getPeak3GainParameter() };
+            case 4:  return { audioProcessor.getPeak4FreqParameter(), audioProcessor.getPeak4GainParameter() };
+            case 5:  return { audioProcessor.getLPFFreqParameter() };
+            default: return {};
+        }
+    };
+
+    // A drag is one gesture, so the host records it as a single edit
+    eqVisualization.onDragStarted = [getBandParameters] (int bandIndex)
+    {
+        for (auto* param : getBandParameters (bandIndex))
+            param->getParameter().beginChangeGesture();
+    };
+
+    eqVisualization.onDragEnded = [getBandParameters] (int bandIndex)
+    {
+        for (auto* param : getBandParameters (bandIndex))
+            param->getParameter().endChangeGesture();
+    };
+
     eqVisualization.onBandDragged = [this] (int bandIndex, float freq, float gain)
     {
         switch (bandIndex)
@@ -475,24 +600,32 @@ StaticCurrentsPluginAudioProcessorEditor::StaticCurrentsPluginAudioProcessorEdit
         updateEQVisualization();
     };
 
-    eqVisualization.onQChanged = [this] (int bandIndex, float q)
+    // Each wheel step is a gesture of its own
+    auto setAsGesture = [] (ParameterHandle* param, float value)
+    {
+        param->getParameter().beginChangeGesture();
+        *param = value;
+        param->getParameter().endChangeGesture();
+    };
+
+    eqVisualization.onQChanged = [this, setAsGesture] (int bandIndex, float q)
     {
         switch (bandIndex)
         {
-            case 1: *audioProcessor.getPeak1QParameter() = q; break;
-            case 2: *audioProcessor.getPeak2QParameter() = q; break;
-            case 3: *audioProcessor.getPeak3QParameter() = q; break;
-            case 4: *audioProcessor.getPeak4QParameter() = q; break;
+            case 1: setAsGesture (audioProcessor.getPeak1QParameter(), q); break;
+            case 2: setAsGesture (audioProcessor.getPeak2QParameter(), q); break;
+            case 3: setAsGesture (audioProcessor.getPeak3QParameter(), q); break;
+            case 4: setAsGesture (audioProcessor.getPeak4QParameter(), q); break;
         }
         updateEQVisualization();
     };
 
-    eqVisualization.onSlopeChanged = [this] (int bandIndex, float slope)
+    eqVisualization.onSlopeChanged = [this, setAsGesture] (int bandIndex, float slope)
     {
         switch (bandIndex)
         {
-            case 0: *audioProcessor.getHPFSlopeParameter() = slope; break;
-            case 5: *audioProcessor.getLPFSlopeParameter() = slope; break;
+            case 0: setAsGesture (audioProcessor.getHPFSlopeParameter(), slope); break;
+            case 5: setAsGesture (audioProcessor.getLPFSlopeParameter(), slope); break;
         }
         updateEQVisualization();
     };
@@ -501,13 +634,11 @@ StaticCurrentsPluginAudioProcessorEditor::StaticCurrentsPluginAudioProcessorEdit
     {
         audioProcessor.applyProfilePreset (0);
         profileBox.setSelectedId (1, juce::dontSendNotification);
-        syncSlidersFromParameters();
         updateEQVisualization();
         
         // Reload the original recorded sample if it exists
-        if (audioProcessor.getOriginalRecordingFile().existsAsFile())
+        if (audioProcessor.restoreOriginalRecording())
         {
-            audioProcessor.loadSampleFromFile(audioProcessor.getOriginalRecordingFile());
             DBG("Reset: Reloaded original recording");
         }
     };
@@ -515,21 +646,28 @@ StaticCurrentsPluginAudioProcessorEditor::StaticCurrentsPluginAudioProcessorEdit
     // Saturation section
     addAndMakeVisible (saturationSectionLabel);
 
-    auto setupSatSlider = [this] (juce::Slider& slider, juce::Label& label,
-                                  float min, float max, float step, float value,
-                                  std::atomic<float>* param,
-                                  int saturationTypeId)
+    // Oversampling: item IDs are the parameter value + 1
+    addAndMakeVisible (oversamplingBox);
+    oversamplingBox.addItemList ({ "1x", "2x", "4x", "8x" }, 1);
+    oversamplingBox.setTooltip ("Saturation oversampling");
+    comboBoxAttachments.push_back (std::make_unique<juce::ComboBoxParameterAttachment> (
+        audioProcessor.getOversamplingParameter()->getParameter(), oversamplingBox));
+
+    addAndMakeVisible (oversamplingModeBox);
+    oversamplingModeBox.addItemList ({ "Min Phase", "Linear Phase" }, 1);
+    oversamplingModeBox.setTooltip ("Oversampling filters: minimum phase (low latency) or linear phase");
+    comboBoxAttachments.push_back (std::make_unique<juce::ComboBoxParameterAttachment> (
+        audioProcessor.getOversamplingModeParameter()->getParameter(), oversamplingModeBox));
+
+    auto setupSatSlider = [this, &attachSlider] (juce::Slider& slider, juce::Label& label,
+                                                 ParameterHandle* param, int decimalPlaces,
+                                                 int saturationTypeId)
     {
         addAndMakeVisible (slider);
         addAndMakeVisible (label);
         slider.setSliderStyle (juce::Slider::RotaryVerticalDrag);
         slider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 70, 16);
-        slider.setRange (min, max, step);
-        slider.setValue (value);
-        slider.onValueChange = [this, param, &slider]
-        {
-            *param = static_cast<float> (slider.getValue());
-        };
+        attachSlider (slider, param, decimalPlaces);
         label.setJustificationType (juce::Justification::centred);
         label.setFont (juce::FontOptions (14.0f));
     };
@@ -541,35 +679,35 @@ StaticCurrentsPluginAudioProcessorEditor::StaticCurrentsPluginAudioProcessorEdit
     addAndMakeVisible (fuzzLabel);
     addAndMakeVisible (bitLabel);
 
-    setupSatSlider (tubeDriveSlider, tubeDriveLabel, 0.0f, 10.0f, 0.1f, 0.0f, audioProcessor.getTubeDriveParameter(), 1);
-    setupSatSlider (tubeWarmthSlider, tubeWarmthLabel, 0.0f, 1.0f, 0.01f, 0.0f, audioProcessor.getTubeWarmthParameter(), 1);
-    setupSatSlider (tubeBiasSlider, tubeBiasLabel, -1.0f, 1.0f, 0.01f, 0.0f, audioProcessor.getTubeBiasParameter(), 1);
-    setupSatSlider (tubeOutputSlider, tubeOutputLabel, 0.0f, 2.0f, 0.01f, 1.0f, audioProcessor.getTubeOutputParameter(), 1);
+    setupSatSlider (tubeDriveSlider, tubeDriveLabel, audioProcessor.getTubeDriveParameter(), 1, 1);
+    setupSatSlider (tubeWarmthSlider, tubeWarmthLabel, audioProcessor.getTubeWarmthParameter(), 2, 1);
+    setupSatSlider (tubeBiasSlider, tubeBiasLabel, audioProcessor.getTubeBiasParameter(), 2, 1);
+    setupSatSlider (tubeOutputSlider, tubeOutputLabel, audioProcessor.getTubeOutputParameter(), 2, 1);
 
-    setupSatSlider (transistorDriveSlider, transistorDriveLabel, 0.0f, 10.0f, 0.1f, 0.0f, audioProcessor.getTransistorDriveParameter(), 2);
-    setupSatSlider (transistorBiteSlider, transistorBiteLabel, 0.0f, 1.0f, 0.01f, 0.0f, audioProcessor.getTransistorBiteParameter(), 2);
-    setupSatSlider (transistorClipSlider, transistorClipLabel, 0.0f, 1.0f, 0.01f, 0.5f, audioProcessor.getTransistorClipParameter(), 2);
-    setupSatSlider (transistorOutputSlider, transistorOutputLabel, 0.0f, 2.0f, 0.01f, 1.0f, audioProcessor.getTransistorOutputParameter(), 2);
+    setupSatSlider (transistorDriveSlider, transistorDriveLabel, audioProcessor.getTransistorDriveParameter(), 1, 2);
+    setupSatSlider (transistorBiteSlider, transistorBiteLabel, audioProcessor.getTransistorBiteParameter(), 2, 2);
+    setupSatSlider (transistorClipSlider, transistorClipLabel, audioProcessor.getTransistorClipParameter(), 2, 2);
+    setupSatSlider (transistorOutputSlider, transistorOutputLabel, audioProcessor.getTransistorOutputParameter(), 2, 2);
 
-    setupSatSlider (tapeDriveSlider, tapeDriveLabel, 0.0f, 10.0f, 0.1f, 0.0f, audioProcessor.getTapeDriveParameter(), 3);
-    setupSatSlider (tapeWowSlider, tapeWowLabel, 0.0f, 1.0f, 0.01f, 0.0f, audioProcessor.getTapeWowParameter(), 3);
-    setupSatSlider (tapeHissSlider, tapeHissLabel, 0.0f, 1.0f, 0.01f, 0.0f, audioProcessor.getTapeHissParameter(), 3);
-    setupSatSlider (tapeOutputSlider, tapeOutputLabel, 0.0f, 2.0f, 0.01f, 1.0f, audioProcessor.getTapeOutputParameter(), 3);
+    setupSatSlider (tapeDriveSlider, tapeDriveLabel, audioProcessor.getTapeDriveParameter(), 1, 3);
+    setupSatSlider (tapeWowSlider, tapeWowLabel, audioProcessor.getTapeWowParameter(), 2, 3);
+    setupSatSlider (tapeHissSlider, tapeHissLabel, audioProcessor.getTapeHissParameter(), 2, 3);
+    setupSatSlider (tapeOutputSlider, tapeOutputLabel, audioProcessor.getTapeOutputParameter(), 2, 3);
 
-    setupSatSlider (diodeDriveSlider, diodeDriveLabel, 0.0f, 10.0f, 0.1f, 0.0f, audioProcessor.getDiodeDriveParameter(), 4);
-    setupSatSlider (diodeAsymSlider, diodeAsymLabel, 0.0f, 1.0f, 0.01f, 0.5f, audioProcessor.getDiodeAsymParameter(), 4);
-    setupSatSlider (diodeClipSlider, diodeClipLabel, 0.0f, 1.0f, 0.01f, 0.5f, audioProcessor.getDiodeClipParameter(), 4);
-    setupSatSlider (diodeOutputSlider, diodeOutputLabel, 0.0f, 2.0f, 0.01f, 1.0f, audioProcessor.getDiodeOutputParameter(), 4);
+    setupSatSlider (diodeDriveSlider, diodeDriveLabel, audioProcessor.getDiodeDriveParameter(), 1, 4);
+    setupSatSlider (diodeAsymSlider, diodeAsymLabel, audioProcessor.getDiodeAsymParameter(), 2, 4);
+    setupSatSlider (diodeClipSlider, diodeClipLabel, audioProcessor.getDiodeClipParameter(), 2, 4);
+    setupSatSlider (diodeOutputSlider, diodeOutputLabel, audioProcessor.getDiodeOutputParameter(), 2, 4);
 
-    setupSatSlider (fuzzDriveSlider, fuzzDriveLabel, 0.0f, 10.0f, 0.1f, 0.0f, audioProcessor.getFuzzDriveParameter(), 5);
-    setupSatSlider (fuzzGateSlider, fuzzGateLabel, 0.0f, 1.0f, 0.01f, 0.0f, audioProcessor.getFuzzGateParameter(), 5);
-    setupSatSlider (fuzzToneSlider, fuzzToneLabel, 0.0f, 1.0f, 0.01f, 0.5f, audioProcessor.getFuzzToneParameter(), 5);
-    setupSatSlider (fuzzOutputSlider, fuzzOutputLabel, 0.0f, 2.0f, 0.01f, 1.0f, audioProcessor.getFuzzOutputParameter(), 5);
+    setupSatSlider (fuzzDriveSlider, fuzzDriveLabel, audioProcessor.getFuzzDriveParameter(), 1, 5);
+    setupSatSlider (fuzzGateSlider, fuzzGateLabel, audioProcessor.getFuzzGateParameter(), 2, 5);
+    setupSatSlider (fuzzToneSlider, fuzzToneLabel, audioProcessor.getFuzzToneParameter(), 2, 5);
+    setupSatSlider (fuzzOutputSlider, fuzzOutputLabel, audioProcessor.getFuzzOutputParameter(), 2, 5);
 
-    setupSatSlider (bitDepthSlider, bitDepthLabel, 2.0f, 16.0f, 1.0f, 16.0f, audioProcessor.getBitDepthParameter(), 6);
-    setupSatSlider (bitRateSlider, bitRateLabel, 1.0f, 16.0f, 1.0f, 1.0f, audioProcessor.getBitRateParameter(), 6);
-    setupSatSlider (bitMixSlider, bitMixLabel, 0.0f, 1.0f, 0.01f, 0.0f, audioProcessor.getBitMixParameter(), 6);
-    setupSatSlider (bitOutputSlider, bitOutputLabel, 0.0f, 2.0f, 0.01f, 1.0f, audioProcessor.getBitOutputParameter(), 6);
+    setupSatSlider (bitDepthSlider, bitDepthLabel, audioProcessor.getBitDepthParameter(), 0, 6);
+    setupSatSlider (bitRateSlider, bitRateLabel, audioProcessor.getBitRateParameter(), 0, 6);
+    setupSatSlider (bitMixSlider, bitMixLabel, audioProcessor.getBitMixParameter(), 2, 6);
+    setupSatSlider (bitOutputSlider, bitOutputLabel, audioProcessor.getBitOutputParameter(), 2, 6);
 
     // Compressor
     addAndMakeVisible (compLabel);
@@ -578,104 +716,100 @@ StaticCurrentsPluginAudioProcessorEditor::StaticCurrentsPluginAudioProcessorEdit
     addAndMakeVisible (compAttackLabel);
     addAndMakeVisible (compReleaseLabel);
     addAndMakeVisible (compMakeupLabel);
+    addAndMakeVisible (compLookaheadLabel);
     addAndMakeVisible (compThreshSlider);
     addAndMakeVisible (compRatioSlider);
     addAndMakeVisible (compAttackSlider);
     addAndMakeVisible (compReleaseSlider);
     addAndMakeVisible (compMakeupSlider);
+    addAndMakeVisible (compLookaheadSlider);
 
     compThreshSlider.setSliderStyle (juce::Slider::RotaryVerticalDrag);
     compThreshSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 60, 16);
-    compThreshSlider.setRange (-60.0, 0.0, 0.1);
-    compThreshSlider.setValue (-20.0);
     compThreshSlider.setTextValueSuffix (" dB");
-    compThreshSlider.onValueChange = [this] { *audioProcessor.getCompThreshParameter() = static_cast<float> (compThreshSlider.getValue()); };
+    attachSlider (compThreshSlider, audioProcessor.getCompThreshParameter(), 1);
 
     compRatioSlider.setSliderStyle (juce::Slider::RotaryVerticalDrag);
     compRatioSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 60, 16);
-    compRatioSlider.setRange (1.0, 20.0, 0.1);
-    compRatioSlider.setValue (4.0);
     compRatioSlider.setTextValueSuffix (":1");
-    compRatioSlider.onValueChange = [this] { *audioProcessor.getCompRatioParameter() = static_cast<float> (compRatioSlider.getValue()); };
+    attachSlider (compRatioSlider, audioProcessor.getCompRatioParameter(), 1);
 
     compAttackSlider.setSliderStyle (juce::Slider::RotaryVerticalDrag);
     compAttackSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 60, 16);
-    compAttackSlider.setRange (0.001, 0.1, 0.001);
-    compAttackSlider.setValue (0.01);
-    compAttackSlider.setSkewFactorFromMidPoint (0.01);
     compAttackSlider.setTextValueSuffix (" s");
-    compAttackSlider.onValueChange = [this] { *audioProcessor.getCompAttackParameter() = static_cast<float> (compAttackSlider.getValue()); };
+    attachSlider (compAttackSlider, audioProcessor.getCompAttackParameter(), 3);
 
     compReleaseSlider.setSliderStyle (juce::Slider::RotaryVerticalDrag);
     compReleaseSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 60, 16);
-    compReleaseSlider.setRange (0.01, 1.0, 0.01);
-    compReleaseSlider.setValue (0.1);
-    compReleaseSlider.setSkewFactorFromMidPoint (0.1);
     compReleaseSlider.setTextValueSuffix (" s");
-    compReleaseSlider.onValueChange = [this] { *audioProcessor.getCompReleaseParameter() = static_cast<float> (compReleaseSlider.getValue()); };
+    attachSlider (compReleaseSlider, audioProcessor.getCompReleaseParameter(), 2);
 
     compMakeupSlider.setSliderStyle (juce::Slider::RotaryVerticalDrag);
     compMakeupSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 60, 16);
-    compMakeupSlider.setRange (0.0, 24.0, 0.1);
-    compMakeupSlider.setValue (0.0);
     compMakeupSlider.setTextValueSuffix (" dB");
-    compMakeupSlider.onValueChange = [this] { *audioProcessor.getCompMakeupParameter() = static_cast<float> (compMakeupSlider.getValue()); };
+    attachSlider (compMakeupSlider, audioProcessor.getCompMakeupParameter(), 1);
+
+    compLookaheadSlider.setSliderStyle (juce::Slider::RotaryVerticalDrag);
+    compLookaheadSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 60, 16);
+    compLookaheadSlider.setTextValueSuffix (" ms");
+    attachSlider (compLookaheadSlider, audioProcessor.getCompLookaheadParameter(), 0);
 
     // Setup click-to-reset listeners for all sliders
-    auto addClickReset = [this] (juce::Slider& slider, double defaultValue)
+    auto addClickReset = [this] (juce::Slider& slider, ParameterHandle* param, double defaultValue)
     {
-        auto listener = std::make_unique<ClickToResetListener>(slider, defaultValue);
+        auto listener = std::make_unique<ClickToResetListener>(slider, defaultValue, param->getParameter());
         slider.addMouseListener(listener.get(), false);
         clickResetListeners.push_back(std::move(listener));
     };
 
     // Basic parameters
-    addClickReset(gainSlider, 0.7);
-    addClickReset(pitchSlider, 1.0);
-    addClickReset(globalOutputSlider, 0.0);
+    addClickReset(gainSlider, audioProcessor.getGainParameter(), 0.7);
+    addClickReset(pitchSlider, audioProcessor.getPitchParameter(), 1.0);
+    addClickReset(globalOutputSlider, audioProcessor.getGlobalOutputParameter(), 0.0);
 
     // Compressor
-    addClickReset(compThreshSlider, 0.0);
-    addClickReset(compRatioSlider, 1.0);
-    addClickReset(compAttackSlider, 0.01);
-    addClickReset(compReleaseSlider, 0.1);
-    addClickReset(compMakeupSlider, 0.0);
+    addClickReset(compThreshSlider, audioProcessor.getCompThreshParameter(), 0.0);
+    addClickReset(compRatioSlider, audioProcessor.getCompRatioParameter(), 1.0);
+    addClickReset(compAttackSlider, audioProcessor.getCompAttackParameter(), 0.01);
+    addClickReset(compReleaseSlider, audioProcessor.getCompReleaseParameter(), 0.1);
+    addClickReset(compMakeupSlider, audioProcessor.getCompMakeupParameter(), 0.0);
+    addClickReset(compLookaheadSlider, audioProcessor.getCompLookaheadParameter(), 0.0);
 
     // Tube saturation
-    addClickReset(tubeDriveSlider, 0.0);
-    addClickReset(tubeWarmthSlider, 0.0);
-    addClickReset(tubeBiasSlider, 0.0);
-    addClickReset(tubeOutputSlider, 1.0);
+    addClickReset(tubeDriveSlider, audioProcessor.getTubeDriveParameter(), 0.0);
+    addClickReset(tubeWarmthSlider, audioProcessor.getTubeWarmthParameter(), 0.0);
+    addClickReset(tubeBiasSlider, audioProcessor.getTubeBiasParameter(), 0.0);
+    addClickReset(tubeOutputSlider, audioProcessor.getTubeOutputParameter(), 1.0);
 
     // Transistor saturation
-    addClickReset(transistorDriveSlider, 0.0);
-    addClickReset(transistorBiteSlider, 0.0);
-    addClickReset(transistorClipSlider, 0.5);
-    addClickReset(transistorOutputSlider, 1.0);
+    addClickReset(transistorDriveSlider, audioProcessor.getTransistorDriveParameter(), 0.0);
+    addClickReset(transistorBiteSlider, audioProcessor.getTransistorBiteParameter(), 0.0);
+    addClickReset(transistorClipSlider, audioProcessor.getTransistorClipParameter(), 0.5);
+    addClickReset(transistorOutputSlider, audioProcessor.getTransistorOutputParameter(), 1.0);
 
     // Tape saturation
-    addClickReset(tapeDriveSlider, 0.0);
-    addClickReset(tapeWowSlider, 0.0);
-    addClickReset(tapeHissSlider, 0.0);
-    addClickReset(tapeOutputSlider, 1.0);
+    addClickReset(tapeDriveSlider, audioProcessor.getTapeDriveParameter(), 0.0);
+    addClickReset(tapeWowSlider, audioProcessor.getTapeWowParameter(), 0.0);
+    addClickReset(tapeHissSlider, audioProcessor.getTapeHissParameter(), 0.0);
+    addClickReset(tapeOutputSlider, audioProcessor.getTapeOutputParameter(), 1.0);
 
     // Diode saturation
-    addClickReset(diodeDriveSlider, 0.0);
-    addClickReset(diodeAsymSlider, 0.5);
-    addClickReset(diodeClipSlider, 0.5);
-    addClickReset(diodeOutputSlider, 1.0);
+    addClickReset(diodeDriveSlider, audioProcessor.getDiodeDriveParameter(), 0.0);
+    addClickReset(diodeAsymSlider, audioProcessor.getDiodeAsymParameter(), 0.5);
+    addClickReset(diodeClipSlider, audioProcessor.getDiodeClipParameter(), 0.5);
+    addClickReset(diodeOutputSlider, audioProcessor.getDiodeOutputParameter(), 1.0);
 
     // Fuzz saturation
-    addClickReset(fuzzDriveSlider, 0.0);
-    addClickReset(fuzzGateSlider, 0.0);
-    addClickReset(fuzzToneSlider, 0.5);
-    addClickReset(fuzzOutputSlider, 1.0);
+    addClickReset(fuzzDriveSlider, audioProcessor.getFuzzDriveParameter(), 0.0);
+    addClickReset(fuzzGateSlider, audioProcessor.getFuzzGateParameter(), 0.0);
+    addClickReset(fuzzToneSlider, audioProcessor.getFuzzToneParameter(), 0.5);
+    addClickReset(fuzzOutputSlider, audioProcessor.getFuzzOutputParameter(), 1.0);
 
     // Bitcrush saturation
-    addClickReset(bitDepthSlider, 16.0);
-    addClickReset(bitRateSlider, 1.0);
-    addClickReset(bitMixSlider, 0.0);
-    addClickReset(bitOutputSlider, 1.0);
+    addClickReset(bitDepthSlider, audioProcessor.getBitDepthParameter(), 16.0);
+    addClickReset(bitRateSlider, audioProcessor.getBitRateParameter(), 1.0);
+    addClickReset(bitMixSlider, audioProcessor.getBitMixParameter(), 0.0);
+    addClickReset(bitOutputSlider, audioProcessor.getBitOutputParameter(), 1.0);
 
     startTimer (50);
 
@@ -723,6 +857,14 @@ StaticCurrentsPluginAudioProcessorEditor::~StaticCurrentsPluginAudioProcessorEdi
 void StaticCurrentsPluginAudioProcessorEditor::timerCallback()
 {
     updateRecordButton();
+    updateExportStatus();
+
+    // The attached controls follow their parameters; these two are drawn from them
+    updateEQVisualization();
+
+    if (profileInitialized && ! profileBox.isPopupActive())
+        profileBox.setSelectedId (juce::roundToInt (audioProcessor.getProfileParameter()->load()) + 1,
+                                  juce::dontSendNotification);
 
     float length = audioProcessor.getSampleLength();
     if (length > 0.0f)
@@ -826,28 +968,17 @@ void StaticCurrentsPluginAudioProcessorEditor::resized()
     {
         profileInitialized = true;
 
-        profileBox.addItem ("-init-", 1);
-        profileBox.addItem ("Wax Cylinder", 2);
-        profileBox.addItem ("Vinyl", 3);
-        profileBox.addItem ("Cassette", 4);
-        profileBox.addItem ("Reel to Reel", 5);
-        profileBox.addItem ("Neve", 6);
-        profileBox.addItem ("API", 7);
-        profileBox.addItem ("Blown Speaker", 8);
-        profileBox.addItem ("HiFi", 9);
-        profileBox.addItem ("LoFi", 10);
-
         profileBox.onChange = [this]
         {
             int profileID = profileBox.getSelectedId() - 1;
             audioProcessor.applyProfilePreset (profileID);
-            syncSlidersFromParameters();
             updateEQVisualization();
         };
 
-        profileBox.setSelectedId (1, juce::dontSendNotification);
-        audioProcessor.applyProfilePreset (0);
-        syncSlidersFromParameters();
+        // Show the processor's current profile - reopening the editor must
+        // not reset a recalled session
+        audioProcessor.applyInitialProfile();
+        refreshProfileBox();
         updateEQVisualization();
     }
 
@@ -886,6 +1017,10 @@ void StaticCurrentsPluginAudioProcessorEditor::resized()
         auto profLabel = profileArea.removeFromLeft (65);
         profileLabel.setBounds (profLabel);
         profileArea.removeFromLeft (4);
+        savePresetButton.setBounds (profileArea.removeFromRight (40));
+        profileArea.removeFromRight (3);
+        compareButton.setBounds (profileArea.removeFromRight (24));
+        profileArea.removeFromRight (3);
         profileBox.setBounds (profileArea);
     }
     
@@ -997,9 +1132,9 @@ void StaticCurrentsPluginAudioProcessorEditor::resized()
     
     compArea.removeFromTop (knobGap);
     
-    // Bottom row: Release, Makeup
+    // Bottom row: Release, Makeup, Lookahead
     auto compBottomRow = compArea;
-    const int bottomRowWidth = compKnobWidth * 2 + compKnobGap;
+    const int bottomRowWidth = compKnobWidth * 3 + compKnobGap * 2;
     auto bottomStrip = compBottomRow.withWidth (bottomRowWidth)
                                 .withX (compBottomRow.getX() + (compBottomRow.getWidth() - bottomRowWidth) / 2);
     
@@ -1038,6 +1173,13 @@ void StaticCurrentsPluginAudioProcessorEditor::resized()
     compMakeupLabel.setJustificationType (juce::Justification::centred);
     compMakeupLabel.setFont (juce::FontOptions (8.0f));
     compMakeupSlider.setBounds (compSlot);
+    compStrip.removeFromLeft (compKnobGap);
+
+    compSlot = compStrip.removeFromLeft (compKnobWidth);
+    compLookaheadLabel.setBounds (compSlot.removeFromTop (12));
+    compLookaheadLabel.setJustificationType (juce::Justification::centred);
+    compLookaheadLabel.setFont (juce::FontOptions (8.0f));
+    compLookaheadSlider.setBounds (compSlot);
     
     // Output knob at bottom of compression section
     globalOutputLabel.setBounds (outputArea.removeFromTop (11));
@@ -1056,7 +1198,10 @@ void StaticCurrentsPluginAudioProcessorEditor::resized()
 
     auto satArea = saturationSectionBounds.reduced (3);
     auto satHeaderArea = satArea.removeFromTop (20);
-    saturationSectionLabel.setBounds (satHeaderArea);
+    oversamplingModeBox.setBounds (satHeaderArea.removeFromRight (100).reduced (1));
+    satHeaderArea.removeFromRight (4);
+    oversamplingBox.setBounds (satHeaderArea.removeFromRight (55).reduced (1));
+    saturationSectionLabel.setBounds (satHeaderArea.withTrimmedLeft (159));
     saturationSectionLabel.setJustificationType (juce::Justification::centred);
     saturationSectionLabel.setFont (juce::FontOptions (12.0f));
 
@@ -1148,7 +1293,9 @@ void StaticCurrentsPluginAudioProcessorEditor::updateRecordButton()
     {
         recordButton.setButtonText ("Stop Recording");
         recordButton.setColour (juce::TextButton::buttonColourId, juce::Colours::red);
-        fileLabel.setText ("RECORDING...", juce::dontSendNotification);
+
+        if (fileLabel.getText() != "Finalizing recording...")
+            fileLabel.setText ("RECORDING...", juce::dontSendNotification);
     }
     else
     {
@@ -1156,8 +1303,63 @@ void StaticCurrentsPluginAudioProcessorEditor::updateRecordButton()
         recordButton.setColour (juce::TextButton::buttonColourId,
                                 getLookAndFeel().findColour (juce::TextButton::buttonColourId));
 
-        if (fileLabel.getText() == "RECORDING...")
-            fileLabel.setText ("Recording complete - sample loaded", juce::dontSendNotification);
+        // Wait for the background finalizer before reporting the result
+        if (audioProcessor.isFinalizingRecording())
+        {
+            fileLabel.setText ("Finalizing recording...", juce::dontSendNotification);
+        }
+        else if (fileLabel.getText() == "RECORDING..." || fileLabel.getText() == "Finalizing recording...")
+        {
+            fileLabel.setText (audioProcessor.hasLoadedSample() ? "Recording complete - sample loaded"
+                                                                : "No sample recorded",
+                               juce::dontSendNotification);
+        }
+    }
+}
+
+void StaticCurrentsPluginAudioProcessorEditor::updateExportStatus()
+{
+    if (batchExportInProgress)
+    {
+        if (audioProcessor.isBatchExporting())
+        {
+            exportButton.setButtonText ("Cancel Export");
+            fileLabel.setText ("Batch exporting... " + juce::String (juce::roundToInt (audioProcessor.getBatchExportProgress() * 100.0f)) + "%",
+                               juce::dontSendNotification);
+            return;
+        }
+
+        batchExportInProgress = false;
+        exportButton.setButtonText ("Export");
+
+        auto reportFile = audioProcessor.writeBatchExportReport();
+        fileLabel.setText ("Batch export done - see " + reportFile.getFileName(), juce::dontSendNotification);
+        DBG (audioProcessor.getBatchExportReport());
+        return;
+    }
+
+    if (! exportInProgress)
+        return;
+
+    if (audioProcessor.isExporting())
+    {
+        exportButton.setButtonText ("Cancel Export");
+        fileLabel.setText ("Exporting... " + juce::String (juce::roundToInt (audioProcessor.getExportProgress() * 100.0f)) + "%",
+                           juce::dontSendNotification);
+        return;
+    }
+
+    exportInProgress = false;
+    exportButton.setButtonText ("Export");
+
+    switch (audioProcessor.getExportState())
+    {
+        case ExportJob::State::finished:    fileLabel.setText ("Export complete", juce::dontSendNotification); break;
+        case ExportJob::State::cancelled:   fileLabel.setText ("Export cancelled", juce::dontSendNotification); break;
+        case ExportJob::State::failed:      fileLabel.setText ("Export failed", juce::dontSendNotification); break;
+        case ExportJob::State::pending:
+        case ExportJob::State::running:
+        default:                            break;
     }
 }
 
@@ -1185,52 +1387,18 @@ void StaticCurrentsPluginAudioProcessorEditor::updateEQVisualization()
                             audioProcessor.getLPFSlopeParameter()->load());
 }
 
-void StaticCurrentsPluginAudioProcessorEditor::syncSlidersFromParameters()
+void StaticCurrentsPluginAudioProcessorEditor::refreshProfileBox()
 {
-    auto setSlider = [] (juce::Slider& slider, float value)
-    {
-        slider.setValue (value, juce::dontSendNotification);
-    };
+    // One item per preset in the bank, IDs offset by one (0 means no selection)
+    const auto& bank = audioProcessor.getPresetBank();
+
+    profileBox.clear (juce::dontSendNotification);
 
-    setSlider (gainSlider, audioProcessor.getGainParameter()->load());
-    setSlider (pitchSlider, audioProcessor.getPitchParameter()->load());
-    setSlider (globalOutputSlider, audioProcessor.getGlobalOutputParameter()->load());
-
-    setSlider (compThreshSlider, audioProcessor.getCompThreshParameter()->load());
-    setSlider (compRatioSlider, audioProcessor.getCompRatioParameter()->load());
-    setSlider (compAttackSlider, audioProcessor.getCompAttackParameter()->load());
-    setSlider (compReleaseSlider, audioProcessor.getCompReleaseParameter()->load());
-    setSlider (compMakeupSlider, audioProcessor.getCompMakeupParameter()->load());
-
-    setSlider (tubeDriveSlider, audioProcessor.getTubeDriveParameter()->load());
-    setSlider (tubeWarmthSlider, audioProcessor.getTubeWarmthParameter()->load());
-    setSlider (tubeBiasSlider, audioProcessor.getTubeBiasParameter()->load());
-    setSlider (tubeOutputSlider, audioProcessor.getTubeOutputParameter()->load());
-
-    setSlider (transistorDriveSlider, audioProcessor.getTransistorDriveParameter()->load());
-    setSlider (transistorBiteSlider, audioProcessor.getTransistorBiteParameter()->load());
-    setSlider (transistorClipSlider, audioProcessor.getTransistorClipParameter()->load());
-    setSlider (transistorOutputSlider, audioProcessor.getTransistorOutputParameter()->load());
-
-    setSlider (tapeDriveSlider, audioProcessor.getTapeDriveParameter()->load());
-    setSlider (tapeWowSlider, audioProcessor.getTapeWowParameter()->load());
-    setSlider (tapeHissSlider, audioProcessor.getTapeHissParameter()->load());
-    setSlider (tapeOutputSlider, audioProcessor.getTapeOutputParameter()->load());
-
-    setSlider (diodeDriveSlider, audioProcessor.getDiodeDriveParameter()->load());
-    setSlider (diodeAsymSlider, audioProcessor.getDiodeAsymParameter()->load());
-    setSlider (diodeClipSlider, audioProcessor.getDiodeClipParameter()->load());
-    setSlider (diodeOutputSlider, audioProcessor.getDiodeOutputParameter()->load());
-
-    setSlider (fuzzDriveSlider, audioProcessor.getFuzzDriveParameter()->load());
-    setSlider (fuzzGateSlider, audioProcessor.getFuzzGateParameter()->load());
-    setSlider (fuzzToneSlider, audioProcessor.getFuzzToneParameter()->load());
-    setSlider (fuzzOutputSlider, audioProcessor.getFuzzOutputParameter()->load());
-
-    setSlider (bitDepthSlider, audioProcessor.getBitDepthParameter()->load());
-    setSlider (bitRateSlider, audioProcessor.getBitRateParameter()->load());
-    setSlider (bitMixSlider, audioProcessor.getBitMixParameter()->load());
-    setSlider (bitOutputSlider, audioProcessor.getBitOutputParameter()->load());
+    for (int i = 0; i < bank.getNumPresets(); ++i)
+        profileBox.addItem (bank.getName (i), i + 1);
+
+    profileBox.setSelectedId (juce::roundToInt (audioProcessor.getProfileParameter()->load()) + 1,
+                              juce::dontSendNotification);
 }
 
 bool StaticCurrentsPluginAudioProcessorEditor::isEffectVersion() const
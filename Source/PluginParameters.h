@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    PluginParameters.h
+
+    The link between the host-facing parameter tree and the audio thread.
+
+    Every parameter lives in the processor's AudioProcessorValueTreeState,
+    so hosts can automate it and get/setStateInformation can save and
+    recall it. The processor, editor and renderer reach single parameters
+    through a ParameterHandle.
+
+    The audio thread doesn't read the tree. Whenever a parameter changes,
+    the chain's snapshot is rebuilt and published through a
+    SnapshotExchange. processBlock() then takes the latest snapshot once
+    per block, with one atomic exchange, so all stages see one consistent
+    set of values. Edits to many parameters at once (presets, state recall)
+    are wrapped in a ScopedBatch and published only when they're complete.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+
+//==============================================================================
+/** One parameter of the tree, as the processor and editor see it. load()
+    reads the plain (denormalised) value without locking. store() and
+    assignment set the value through the parameter, so the host is told.
+*/
+class ParameterHandle
+{
+public:
+    ParameterHandle (juce::AudioProcessorValueTreeState& state, const juce::String& parameterID)
+        : parameter (state.getParameter (parameterID)),
+          value (state.getRawParameterValue (parameterID))
+    {
+        jassert (parameter != nullptr && value != nullptr); // missing from createParameterLayout()
+    }
+
+    float load() const noexcept     { return value->load (std::memory_order_relaxed); }
+
+    void store (float newValue)
+    {
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (newValue));
+    }
+
+    ParameterHandle& operator= (float newValue)
+    {
+        store (newValue);
+        return *this;
+    }
+
+    juce::RangedAudioParameter& getParameter() const noexcept   { return *parameter; }
+
+private:
+    juce::RangedAudioParameter* parameter;
+    std::atomic<float>* value;
+
+    JUCE_DECLARE_NON_COPYABLE (ParameterHandle)
+};
+
+//==============================================================================
+/** Passes a Snapshot from the threads that change parameters to the audio
+    thread, without locks or allocation.
+
+    Three buffers rotate between the two sides. The writer fills its own
+    buffer and swaps it into the middle slot. When a newer buffer is
+    waiting there, the reader swaps its own buffer for it. Writers on
+    different threads (the message thread, a host's automation thread) are
+    combined, not serialised. A writer that finds another one mid-publish
+    marks the snapshot pending and returns at once, and the busy writer
+    publishes again before it finishes.
+*/
+template <typename Snapshot>
+class SnapshotExchange
+{
+public:
+    /** build fills a snapshot from the current parameter values. It can
+        run on any thread that calls publish(), on behalf of any other.
+    */
+    explicit SnapshotExchange (std::function<void (Snapshot&)> buildFunction)
+        : build (std::move (buildFunction))
+    {
+        for (auto& buffer : buffers)
+            build (buffer);
+    }
+
+    /** Rebuilds and publishes the snapshot. If a batch is open, this only
+        marks the snapshot pending; the batch publishes it when it ends.
+    */
+    void publish()
+    {
+        pending.store (true);
+
+        while (pending.load() && openBatches.load() == 0)
+        {
+            if (publishing.exchange (true))
+                return; // the publishing thread sees pending and goes round again
+
+            if (pending.exchange (false))
+            {
+                // A batch begun before the build is still counted in openBatches.
+                // One begun during it moves batchesBegun. Either way the values
+                // may be half changed; the batch publishes them when it ends.
+                const auto batches = batchesBegun.load();
+                auto complete = openBatches.load() == 0;
+
+                if (complete)
+                {
+                    build (buffers[writeIndex]);
+                    complete = batchesBegun.load() == batches;
+                }
+
+                if (complete)
+                    writeIndex = middle.exchange (writeIndex | freshBit) & indexMask;
+                else
+                    pending.store (true);
+            }
+
+            publishing.store (false);
+        }
+    }
+
+    /** The latest published snapshot. Only call this from one thread (the
+        audio thread). The reference stays valid until the next call.
+    */
+    const Snapshot& acquire() noexcept
+    {
+        if ((middle.load (std::memory_order_relaxed) & freshBit) != 0)
+            readIndex = middle.exchange (readIndex) & indexMask;
+
+        return buffers[readIndex];
+    }
+
+    //==============================================================================
+    /** Holds publishing back while several parameters change together. The
+        outermost batch publishes once when it ends.
+    */
+    class ScopedBatch
+    {
+    public:
+        explicit ScopedBatch (SnapshotExchange& exchangeToHold)
+            : exchange (exchangeToHold)
+        {
+            exchange.openBatches.fetch_add (1);
+            exchange.batchesBegun.fetch_add (1);
+        }
+
+        ~ScopedBatch()
+        {
+            if (exchange.openBatches.fetch_sub (1) == 1)
+                exchange.publish();
+        }
+
+    private:
+        SnapshotExchange& exchange;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBatch)
+    };
+
+private:
+    //==============================================================================
+    static constexpr int indexMask = 3, freshBit = 4;
+
+    std::function<void (Snapshot&)> build;
+    Snapshot buffers[3];
+    int writeIndex = 0;     // owned by whichever thread holds publishing
+    int readIndex = 1;      // owned by the reader
+    std::atomic<int> middle { 2 };
+
+    std::atomic<bool> pending { false }, publishing { false };
+    std::atomic<int> openBatches { 0 }, batchesBegun { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (SnapshotExchange)
+};
@@ -9,12 +9,20 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "TubeSaturation.h"
+#include "EffectsChain.h"
+#include "SampleRecorder.h"
+#include "SampleExporter.h"
+#include "PluginParameters.h"
+#include "SessionState.h"
+#include "SamplerCommands.h"
+#include "SamplerEngine.h"
+#include "PresetBank.h"
 
 //==============================================================================
 /**
 */
-class StaticCurrentsPluginAudioProcessor  : public juce::AudioProcessor
+class StaticCurrentsPluginAudioProcessor  : public juce::AudioProcessor,
+                                            private juce::AudioProcessorValueTreeState::Listener
 {
 public:
     //==============================================================================
@@ -25,12 +33,17 @@ public:
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
 
+    /** Widest bus layout accepted (16 channels covers 9.1.6). */
+    static constexpr int maxBusChannels = 16;
+
    #ifndef JucePlugin_PreferredChannelConfigurations
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -61,228 +74,314 @@ public:
     // Recording functionality
     void startRecording();
     void stopRecording();
-    bool isRecording() const { return recording; }
-    bool hasLoadedSample() const { return sampler.getNumSounds() > 0; }
-    void triggerSamplePlayback() { shouldTriggerNote.store(true); }
-    void stopSamplePlayback() { shouldStopNote.store(true); }
+    bool isRecording() const { return recording.load(); }
+    bool isFinalizingRecording() const { return recording.load() || recorder.isBusy(); }
+    bool hasLoadedSample() const { return sampleLength.load() > 0.0f; }
+    
+    // Transport requests are queued for the audio thread, which applies them
+    // in order at the start of its next block
+    void triggerSamplePlayback() { samplerCommands.post (SamplerCommand::play()); }
+    void stopSamplePlayback() { samplerCommands.post (SamplerCommand::stop()); }
     void setLoopPlayback(bool shouldLoop) { loopPlayback.store(shouldLoop); }
     bool isLoopPlaybackEnabled() const { return loopPlayback.load(); }
-    bool isCurrentlyPlaying() const { return isNoteCurrentlyPlaying; }
-    void seekToPosition(float positionInSeconds) { seekPosition.store(positionInSeconds); }
-    void exportProcessedSample(const juce::File& outputFile);
+    bool isCurrentlyPlaying() const { return isNoteCurrentlyPlaying.load(); }
+    void seekToPosition(float positionInSeconds) { samplerCommands.post (SamplerCommand::seek (positionInSeconds)); }
+    
+    // Export runs in the background; the editor polls progress from its timer
+    bool exportProcessedSample(const juce::File& outputFile);
+    void cancelExport() { exporter.cancel(); }
+    bool isExporting() const { return exporter.isRunning(); }
+    float getExportProgress() const { return exporter.getProgress(); }
+    ExportJob::State getExportState() const { return exporter.getState(); }
+    
+    // Batch export - every audio file in a folder, in parallel, into <folder>/Processed
+    int startBatchExport(const juce::File& sourceDirectory, const juce::String& extension);
+    void cancelBatchExport() { batchExporter.cancel(); }
+    bool isBatchExporting() const { return batchExporter.isRunning(); }
+    float getBatchExportProgress() const { return batchExporter.getProgress(); }
+    juce::String getBatchExportReport() const { return batchExporter.createReport(); }
+    juce::File writeBatchExportReport() const { return batchExporter.writeReport(); }
     
     // Playback position tracking
     float getPlaybackPosition() const { return playbackPosition.load(); }
     float getSampleLength() const { return sampleLength.load(); }
-    void setPlaybackPosition(float pos) { seekPosition.store(pos); }
+    void setPlaybackPosition(float pos) { seekToPosition (pos); }
     
     // Jumbler functionality
     void jumbleSample();
     
     // Parameter access
-    std::atomic<float>* getGainParameter() { return &gain; }
-    std::atomic<float>* getPitchParameter() { return &pitch; }
-    std::atomic<float>* getSaturationParameter() { return &saturation; }
-    std::atomic<float>* getSaturationTypeParameter() { return &saturationType; }
-    std::atomic<float>* getProfileParameter() { return &profileType; }
+    ParameterHandle* getGainParameter() { return &gain; }
+    ParameterHandle* getPitchParameter() { return &pitch; }
+    ParameterHandle* getSaturationParameter() { return &saturation; }
+    ParameterHandle* getSaturationTypeParameter() { return &saturationType; }
+    ParameterHandle* getProfileParameter() { return &profileType; }
 
     // Saturation type parameter accessors
-    std::atomic<float>* getTubeDriveParameter() { return &tubeDrive; }
-    std::atomic<float>* getTubeWarmthParameter() { return &tubeWarmth; }
-    std::atomic<float>* getTubeBiasParameter() { return &tubeBias; }
-    std::atomic<float>* getTubeOutputParameter() { return &tubeOutput; }
+    ParameterHandle* getTubeDriveParameter() { return &tubeDrive; }
+    ParameterHandle* getTubeWarmthParameter() { return &tubeWarmth; }
+    ParameterHandle* getTubeBiasParameter() { return &tubeBias; }
+    ParameterHandle* getTubeOutputParameter() { return &tubeOutput; }
 
-    std::atomic<float>* getTransistorDriveParameter() { return &transistorDrive; }
-    std::atomic<float>* getTransistorBiteParameter() { return &transistorBite; }
-    std::atomic<float>* getTransistorClipParameter() { return &transistorClip; }
-    std::atomic<float>* getTransistorOutputParameter() { return &transistorOutput; }
+    ParameterHandle* getTransistorDriveParameter() { return &transistorDrive; }
+    ParameterHandle* getTransistorBiteParameter() { return &transistorBite; }
+    ParameterHandle* getTransistorClipParameter() { return &transistorClip; }
+    ParameterHandle* getTransistorOutputParameter() { return &transistorOutput; }
 
-    std::atomic<float>* getTapeDriveParameter() { return &tapeDrive; }
-    std::atomic<float>* getTapeWowParameter() { return &tapeWow; }
-    std::atomic<float>* getTapeHissParameter() { return &tapeHiss; }
-    std::atomic<float>* getTapeOutputParameter() { return &tapeOutput; }
+    ParameterHandle* getTapeDriveParameter() { return &tapeDrive; }
+    ParameterHandle* getTapeWowParameter() { return &tapeWow; }
+    ParameterHandle* getTapeHissParameter() { return &tapeHiss; }
+    ParameterHandle* getTapeOutputParameter() { return &tapeOutput; }
 
-    std::atomic<float>* getDiodeDriveParameter() { return &diodeDrive; }
-    std::atomic<float>* getDiodeAsymParameter() { return &diodeAsym; }
-    std::atomic<float>* getDiodeClipParameter() { return &diodeClip; }
-    std::atomic<float>* getDiodeOutputParameter() { return &diodeOutput; }
+    ParameterHandle* getDiodeDriveParameter() { return &diodeDrive; }
+    ParameterHandle* getDiodeAsymParameter() { return &diodeAsym; }
+    ParameterHandle* getDiodeClipParameter() { return &diodeClip; }
+    ParameterHandle* getDiodeOutputParameter() { return &diodeOutput; }
 
-    std::atomic<float>* getFuzzDriveParameter() { return &fuzzDrive; }
-    std::atomic<float>* getFuzzGateParameter() { return &fuzzGate; }
-    std::atomic<float>* getFuzzToneParameter() { return &fuzzTone; }
-    std::atomic<float>* getFuzzOutputParameter() { return &fuzzOutput; }
+    ParameterHandle* getFuzzDriveParameter() { return &fuzzDrive; }
+    ParameterHandle* getFuzzGateParameter() { return &fuzzGate; }
+    ParameterHandle* getFuzzToneParameter() { return &fuzzTone; }
+    ParameterHandle* getFuzzOutputParameter() { return &fuzzOutput; }
 
-    std::atomic<float>* getBitDepthParameter() { return &bitDepth; }
-    std::atomic<float>* getBitRateParameter() { return &bitRate; }
-    std::atomic<float>* getBitMixParameter() { return &bitMix; }
-    std::atomic<float>* getBitOutputParameter() { return &bitOutput; }
+    ParameterHandle* getBitDepthParameter() { return &bitDepth; }
+    ParameterHandle* getBitRateParameter() { return &bitRate; }
+    ParameterHandle* getBitMixParameter() { return &bitMix; }
+    ParameterHandle* getBitOutputParameter() { return &bitOutput; }
     
     // 6-Band Parametric EQ accessors
-    std::atomic<float>* getHPFFreqParameter() { return &hpfFreq; }
-    std::atomic<float>* getHPFSlopeParameter() { return &hpfSlope; }
-    std::atomic<float>* getPeak1FreqParameter() { return &peak1Freq; }
-    std::atomic<float>* getPeak1GainParameter() { return &peak1Gain; }
-    std::atomic<float>* getPeak1QParameter() { return &peak1Q; }
-    std::atomic<float>* getPeak2FreqParameter() { return &peak2Freq; }
-    std::atomic<float>* getPeak2GainParameter() { return &peak2Gain; }
-    std::atomic<float>* getPeak2QParameter() { return &peak2Q; }
-    std::atomic<float>* getPeak3FreqParameter() { return &peak3Freq; }
-    std::atomic<float>* getPeak3GainParameter() { return &peak3Gain; }
-    std::atomic<float>* getPeak3QParameter() { return &peak3Q; }
-    std::atomic<float>* getPeak4FreqParameter() { return &peak4Freq; }
-    std::atomic<float>* getPeak4GainParameter() { return &peak4Gain; }
-    std::atomic<float>* getPeak4QParameter() { return &peak4Q; }
-    std::atomic<float>* getLPFFreqParameter() { return &lpfFreq; }
-    std::atomic<float>* getLPFSlopeParameter() { return &lpfSlope; }
+    ParameterHandle* getHPFFreqParameter() { return &hpfFreq; }
+    ParameterHandle* getHPFSlopeParameter() { return &hpfSlope; }
+    ParameterHandle* getPeak1FreqParameter() { return &peak1Freq; }
+    ParameterHandle* getPeak1GainParameter() { return &peak1Gain; }
+    ParameterHandle* getPeak1QParameter() { return &peak1Q; }
+    ParameterHandle* getPeak2FreqParameter() { return &peak2Freq; }
+    ParameterHandle* getPeak2GainParameter() { return &peak2Gain; }
+    ParameterHandle* getPeak2QParameter() { return &peak2Q; }
+    ParameterHandle* getPeak3FreqParameter() { return &peak3Freq; }
+    ParameterHandle* getPeak3GainParameter() { return &peak3Gain; }
+    ParameterHandle* getPeak3QParameter() { return &peak3Q; }
+    ParameterHandle* getPeak4FreqParameter() { return &peak4Freq; }
+    ParameterHandle* getPeak4GainParameter() { return &peak4Gain; }
+    ParameterHandle* getPeak4QParameter() { return &peak4Q; }
+    ParameterHandle* getLPFFreqParameter() { return &lpfFreq; }
+    ParameterHandle* getLPFSlopeParameter() { return &lpfSlope; }
     
     // Compressor accessors
-    std::atomic<float>* getCompThreshParameter() { return &compThresh; }
-    std::atomic<float>* getCompRatioParameter() { return &compRatio; }
-    std::atomic<float>* getCompAttackParameter() { return &compAttack; }
-    std::atomic<float>* getCompReleaseParameter() { return &compRelease; }
-    std::atomic<float>* getCompMakeupParameter() { return &compMakeup; }
+    ParameterHandle* getCompThreshParameter() { return &compThresh; }
+    ParameterHandle* getCompRatioParameter() { return &compRatio; }
+    ParameterHandle* getCompAttackParameter() { return &compAttack; }
+    ParameterHandle* getCompReleaseParameter() { return &compRelease; }
+    ParameterHandle* getCompMakeupParameter() { return &compMakeup; }
+    ParameterHandle* getCompLookaheadParameter() { return &compLookahead; }
+    
+    // Saturation oversampling accessors
+    ParameterHandle* getOversamplingParameter() { return &oversampling; }
+    ParameterHandle* getOversamplingModeParameter() { return &oversamplingMode; }
     
     // Global Output accessor
-    std::atomic<float>* getGlobalOutputParameter() { return &globalOutput; }
+    ParameterHandle* getGlobalOutputParameter() { return &globalOutput; }
+    
+    ParameterHandle* getBypassParameterHandle() { return &bypass; }
+    bool isBypassed() const { return bypass.load() >= 0.5f; }
+    void setBypassed(bool shouldBeBypassed) { bypass.store(shouldBeBypassed ? 1.0f : 0.0f); }
     
-    std::atomic<bool>* getBypassParameter() { return &bypass; }    
-    // Preset application
+    // Preset application - profileID indexes the shared preset bank
     void applyProfilePreset(int profileID);
+    const PresetBank& getPresetBank() const { return *presetBank; }
+    
+    // Saves the current settings as a user preset and selects it; returns
+    // its index, or -1 if it couldn't be saved
+    int saveUserPreset(const juce::String& name);
+    
+    // A/B comparison: switching slots keeps the settings of the one left and
+    // recalls the other (a slot not used yet starts from the current settings)
+    void selectComparisonSlot(int slot);
+    int getComparisonSlot() const { return comparisonSlot; }
+    
+    // Applies the -init- profile when the first editor opens on a fresh
+    // instance; a recalled session or an applied profile is left alone
+    void applyInitialProfile();
+    
+    // Snapshot of every effects parameter, read straight from the tree.
+    // The audio thread uses the published copy in chainSnapshot instead.
+    ChainParameters getChainParameters() const;
+    
+    // Look up a parameter by its name (e.g. "tubeDrive"); nullptr if unknown.
+    // Used by parameter files in headless renders.
+    ParameterHandle* findParameter(const juce::String& name);
+    static juce::StringArray getParameterNames();
     
     // Get original recording file for reset functionality
-    juce::File getOriginalRecordingFile() const { return originalRecordingFile; }
+    juce::File getOriginalRecordingFile() const { return recorder.getLastWrittenFile(); }
+    
+    // Reinstall the last recording from memory; false if nothing was recorded
+    bool restoreOriginalRecording();
 private:
   void clearLoadedSample();
+  void installSampleData (SampleData::Ptr data, const juce::File& sourceFile = {}, DiskSampleSource::Ptr stream = {});
+  SampleData::Ptr getSessionSample (juce::File* sourceFile = nullptr);
+  void setSessionSample (SampleData::Ptr data, const juce::File& sourceFile);
+  void finishRecording();
+  void installFinishedRecording();
+  void applySamplerCommands (juce::MidiBuffer& midiMessages, int numSamples);
+  void replaceSound (juce::SynthesiserSound* newSound);
+  std::vector<float> capturePresetValues() const;
+  void applyPresetValues (const float* values);
   juce::File createRecordingTempFile() const;
   bool isEffectVersion() const;
+  void parameterChanged (const juce::String& parameterID, float newValue) override;
+  static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
     //==============================================================================
-    juce::Synthesiser sampler;
+    // Refills the voices' streams of a sample played from disk. Declared
+    // before everything that can hold a streamed sound, so it outlives them.
+    juce::TimeSliceThread sampleStreamThread { "Sample Streaming" };
+
+    SamplerEngine sampler;
+    juce::AudioProcessLoadMeasurer samplerLoad;    // the sampler's own render time, for its voice back-off
     juce::AudioFormatManager formatManager;
     
-    // Recording state
-    bool recording = false;
-    juce::AudioBuffer<float> recordBuffer;
-    int recordPosition = 0;
-    double recordSampleRate = 44100.0;
+    // Recording state - the take is streamed to disk by the audio thread
+    // while recording and handed to the finalizer when it stops
+    SampleRecorder recorder;
+    std::atomic<bool> recording { false };
+    std::atomic<bool> stopRequested { false };
+    std::unique_ptr<SampleRecorder::Take> currentTake;
     juce::File lastRecordingFile;
-    juce::File originalRecordingFile; // Tracks the last recorded sample (not jumbled/loaded)
+    
+    // Background export workers
+    SampleExporter exporter;
+    BatchExporter batchExporter;
+    
     bool clearedOnStart = false;
     bool isEffect = false;
     
-    // Parameters
-    std::atomic<float> gain { 0.7f };       // 0.0 to 1.0
-    std::atomic<float> pitch { 1.0f };      // 0.5 to 2.0 (semitones)
-    std::atomic<float> saturation { 1.0f };  // 0.0 to 1.0 (global mix)
-    std::atomic<float> saturationType { 1.0f }; // 1=Tube, 2=Transistor, 3=Tape, 4=Diode, 5=Fuzz, 6=BitCrush
-    std::atomic<float> profileType { 1.0f };    // 1=Wax, 2=Vinyl, 3=Cassette, 4=Reel, 5=Neve, 6=API, 7=Speaker, 8=HiFi, 9=LoFi
+    // Parameters - host-automatable and saved with the session. Ranges and
+    // defaults are in createParameterLayout().
+    juce::AudioProcessorValueTreeState parameters { *this, nullptr, "StaticCurrentsParameters", createParameterLayout() };
+    
+    ParameterHandle gain { parameters, "gain" };
+    ParameterHandle pitch { parameters, "pitch" };
+    ParameterHandle polyphony { parameters, "polyphony" };
+    ParameterHandle saturation { parameters, "saturation" };
+    ParameterHandle saturationType { parameters, "saturationType" };
+    ParameterHandle profileType { parameters, "profileType" };
 
     // Saturation type parameters
-    std::atomic<float> tubeDrive { 4.0f };    // 0.0 to 10.0
-    std::atomic<float> tubeWarmth { 0.5f };   // 0.0 to 1.0
-    std::atomic<float> tubeBias { 0.0f };     // -1.0 to 1.0
-    std::atomic<float> tubeOutput { 1.0f };   // 0.0 to 2.0
+    ParameterHandle tubeDrive { parameters, "tubeDrive" };
+    ParameterHandle tubeWarmth { parameters, "tubeWarmth" };
+    ParameterHandle tubeBias { parameters, "tubeBias" };
+    ParameterHandle tubeOutput { parameters, "tubeOutput" };
 
-    std::atomic<float> transistorDrive { 4.0f };  // 0.0 to 10.0
-    std::atomic<float> transistorBite { 0.5f };   // 0.0 to 1.0
-    std::atomic<float> transistorClip { 0.5f };   // 0.0 to 1.0
-    std::atomic<float> transistorOutput { 1.0f }; // 0.0 to 2.0
+    ParameterHandle transistorDrive { parameters, "transistorDrive" };
+    ParameterHandle transistorBite { parameters, "transistorBite" };
+    ParameterHandle transistorClip { parameters, "transistorClip" };
+    ParameterHandle transistorOutput { parameters, "transistorOutput" };
 
-    std::atomic<float> tapeDrive { 4.0f };    // 0.0 to 10.0
-    std::atomic<float> tapeWow { 0.2f };      // 0.0 to 1.0
-    std::atomic<float> tapeHiss { 0.1f };     // 0.0 to 1.0
-    std::atomic<float> tapeOutput { 1.0f };   // 0.0 to 2.0
+    ParameterHandle tapeDrive { parameters, "tapeDrive" };
+    ParameterHandle tapeWow { parameters, "tapeWow" };
+    ParameterHandle tapeHiss { parameters, "tapeHiss" };
+    ParameterHandle tapeOutput { parameters, "tapeOutput" };
 
-    std::atomic<float> diodeDrive { 4.0f };   // 0.0 to 10.0
-    std::atomic<float> diodeAsym { 0.5f };    // 0.0 to 1.0
-    std::atomic<float> diodeClip { 0.5f };    // 0.0 to 1.0
-    std::atomic<float> diodeOutput { 1.0f };  // 0.0 to 2.0
+    ParameterHandle diodeDrive { parameters, "diodeDrive" };
+    ParameterHandle diodeAsym { parameters, "diodeAsym" };
+    ParameterHandle diodeClip { parameters, "diodeClip" };
+    ParameterHandle diodeOutput { parameters, "diodeOutput" };
 
-    std::atomic<float> fuzzDrive { 6.0f };    // 0.0 to 10.0
-    std::atomic<float> fuzzGate { 0.2f };     // 0.0 to 1.0
-    std::atomic<float> fuzzTone { 0.5f };     // 0.0 to 1.0
-    std::atomic<float> fuzzOutput { 1.0f };   // 0.0 to 2.0
+    ParameterHandle fuzzDrive { parameters, "fuzzDrive" };
+    ParameterHandle fuzzGate { parameters, "fuzzGate" };
+    ParameterHandle fuzzTone { parameters, "fuzzTone" };
+    ParameterHandle fuzzOutput { parameters, "fuzzOutput" };
 
-    std::atomic<float> bitDepth { 8.0f };     // 2.0 to 16.0
-    std::atomic<float> bitRate { 4.0f };      // 1.0 to 16.0 (downsample factor)
-    std::atomic<float> bitMix { 1.0f };       // 0.0 to 1.0
-    std::atomic<float> bitOutput { 1.0f };    // 0.0 to 2.0
+    ParameterHandle bitDepth { parameters, "bitDepth" };
+    ParameterHandle bitRate { parameters, "bitRate" };
+    ParameterHandle bitMix { parameters, "bitMix" };
+    ParameterHandle bitOutput { parameters, "bitOutput" };
     
     // 6-Band Parametric EQ
-    std::atomic<float> hpfFreq { 20.0f };    // 20 to 500 Hz (starts all the way left)
-    std::atomic<float> hpfSlope { 1.0f };    // 1 = 12dB/oct, 2 = 24dB/oct, 8 = 96dB/oct
-    std::atomic<float> peak1Freq { 200.0f }; // 20 to 500 Hz
-    std::atomic<float> peak1Gain { 0.0f };   // -12 to 12 dB
-    std::atomic<float> peak1Q { 1.0f };      // 0.3 to 5.0
-    std::atomic<float> peak2Freq { 800.0f }; // 100 to 2000 Hz
-    std::atomic<float> peak2Gain { 0.0f };   // -12 to 12 dB
-    std::atomic<float> peak2Q { 1.0f };      // 0.3 to 5.0
-    std::atomic<float> peak3Freq { 2000.0f };// 500 to 5000 Hz
-    std::atomic<float> peak3Gain { 0.0f };   // -12 to 12 dB
-    std::atomic<float> peak3Q { 1.0f };      // 0.3 to 5.0
-    std::atomic<float> peak4Freq { 6000.0f };// 1000 to 10000 Hz
-    std::atomic<float> peak4Gain { 0.0f };   // -12 to 12 dB  
-    std::atomic<float> peak4Q { 1.0f };      // 0.3 to 5.0
-    std::atomic<float> lpfFreq { 20000.0f }; // 3000 to 20000 Hz (starts all the way right)
-    std::atomic<float> lpfSlope { 1.0f };    // 1 = 12dB/oct, 2 = 24dB/oct, 8 = 96dB/oct
+    ParameterHandle hpfFreq { parameters, "hpfFreq" };
+    ParameterHandle hpfSlope { parameters, "hpfSlope" };
+    ParameterHandle peak1Freq { parameters, "peak1Freq" };
+    ParameterHandle peak1Gain { parameters, "peak1Gain" };
+    ParameterHandle peak1Q { parameters, "peak1Q" };
+    ParameterHandle peak2Freq { parameters, "peak2Freq" };
+    ParameterHandle peak2Gain { parameters, "peak2Gain" };
+    ParameterHandle peak2Q { parameters, "peak2Q" };
+    ParameterHandle peak3Freq { parameters, "peak3Freq" };
+    ParameterHandle peak3Gain { parameters, "peak3Gain" };
+    ParameterHandle peak3Q { parameters, "peak3Q" };
+    ParameterHandle peak4Freq { parameters, "peak4Freq" };
+    ParameterHandle peak4Gain { parameters, "peak4Gain" };
+    ParameterHandle peak4Q { parameters, "peak4Q" };
+    ParameterHandle lpfFreq { parameters, "lpfFreq" };
+    ParameterHandle lpfSlope { parameters, "lpfSlope" };
     
     // Compressor
-    std::atomic<float> compThresh { -20.0f };   // -60 to 0 dB
-    std::atomic<float> compRatio { 4.0f };      // 1 to 20
-    std::atomic<float> compAttack { 0.01f };    // 0.001 to 0.1 s
-    std::atomic<float> compRelease { 0.1f };    // 0.01 to 1.0 s
-    std::atomic<float> compMakeup { 0.0f };     // 0 to 24 dB
+    ParameterHandle compThresh { parameters, "compThresh" };
+    ParameterHandle compRatio { parameters, "compRatio" };
+    ParameterHandle compAttack { parameters, "compAttack" };
+    ParameterHandle compRelease { parameters, "compRelease" };
+    ParameterHandle compMakeup { parameters, "compMakeup" };
+    ParameterHandle compLookahead { parameters, "compLookahead" };
+    
+    // Saturation oversampling (a quality setting, so profiles leave it alone)
+    ParameterHandle oversampling { parameters, "oversampling" };
+    ParameterHandle oversamplingMode { parameters, "oversamplingMode" };
     
     // Global Output
-    std::atomic<float> globalOutput { 0.0f };   // -24 to +6 dB, default 0 dB
+    ParameterHandle globalOutput { parameters, "globalOutput" };
+    
+    // Session state: embed the sample as FLAC (1) or reference its file (0)
+    ParameterHandle embedSample { parameters, "embedSample" };
+    
+    ParameterHandle bypass { parameters, "bypass" };
+    
+    // Presets: the bank (parsed once, shared by every instance), the
+    // parameter behind each of its columns, and the two A/B slots
+    juce::SharedResourcePointer<PresetBank> presetBank;
+    std::vector<ParameterHandle*> presetParameters;
     
-    std::atomic<bool> bypass { false };
+    struct ComparisonSlot
+    {
+        std::vector<float> values;
+        int profile = 0;
+    };
     
-    // Playback tracking
-    std::atomic<bool> shouldTriggerNote { false };
-    std::atomic<bool> shouldStopNote { false };
+    ComparisonSlot comparisonSlots[2];
+    int comparisonSlot = 0;
+    
+    // The chain's copy of the parameters, republished whenever one changes
+    SnapshotExchange<ChainParameters> chainSnapshot { [this] (ChainParameters& p) { p = getChainParameters(); } };
+    
+    // The editor's transport and sample changes, drained by processBlock()
+    SamplerCommandQueue samplerCommands;
+    juce::MidiBuffer commandNotes;
+    
+    // Playback tracking (the plain members belong to the audio thread)
     std::atomic<bool> loopPlayback { false };
     std::atomic<float> playbackPosition { 0.0f };
     std::atomic<float> sampleLength { 0.0f };
-    std::atomic<float> seekPosition { -1.0f };
     int lastNoteTriggered = -1;
-    int currentlyPlayingVoiceIndex = -1;
-    int64_t samplesSinceNoteOn = 0;
-    bool isNoteCurrentlyPlaying = false;
-    float lastPitchValue = 1.0f;
-    
-    // Recording
-    std::atomic<bool> recordingActive { false };
-    
-    // DSP state - 6-band parametric EQ
-    // Multiple stages for HPF/LPF to handle slope properly
-    juce::IIRFilter hpfL[8], hpfR[8];  // Up to 8 cascaded stages for 96dB/oct
-    juce::IIRFilter peak1L, peak1R;
-    juce::IIRFilter peak2L, peak2R;
-    juce::IIRFilter peak3L, peak3R;
-    juce::IIRFilter peak4L, peak4R;
-    juce::IIRFilter lpfL[8], lpfR[8];  // Up to 8 cascaded stages for 96dB/oct
-    
-    // FET-style compressor state
-    float compEnvelope = 0.0f;
-    float compKneeWidth = 6.0f;  // Soft knee width in dB for FET character
-    
-    // Tube saturation processor
-    std::unique_ptr<TubeSaturation> tubeSaturation;
+    double notePosition = 0.0;     // seconds into the sample of the transport's note
+    std::atomic<bool> isNoteCurrentlyPlaying { false };
+    
+    // DSP - the effects chain shared with offline export
+    EffectsChain effectsChain;
+    
+    // The sample saved with the session and, if it came from a file, that
+    // file (a streamed sample is only the file). A recording is installed on
+    // the audio thread, which can't take the lock, so it only raises
+    // recordingInstalled.
+    juce::CriticalSection sessionSampleLock;
+    SampleData::Ptr sessionSample;
+    juce::File sessionSampleFile;
+    std::atomic<bool> recordingInstalled { false };
+    std::atomic<bool> sessionInitialised { false };
+    
+    // Keeps the session sample's FLAC ready for the next save
+    SampleEncoder sampleEncoder { [this] { return getSessionSample(); } };
     
     double currentSampleRate = 44100.0;
-    double tapeWowPhase = 0.0;
-    juce::Random tapeNoise;
-    float fuzzToneStateL = 0.0f;
-    float fuzzToneStateR = 0.0f;
-    int bitcrushCounterL = 0;
-    int bitcrushCounterR = 0;
-    float bitcrushHoldL = 0.0f;
-    float bitcrushHoldR = 0.0f;
-    
-    // Smoothed slope parameters to avoid clicks
-    juce::SmoothedValue<float> smoothedHpfSlope;
-    juce::SmoothedValue<float> smoothedLpfSlope;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StaticCurrentsPluginAudioProcessor)
 };
@@ -0,0 +1,253 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+
+    The profiles, as data rather than code.
+
+    A bank is a JSON file:
+
+        { "name": "My Bank",
+          "defaults": { "tubeDrive": 2.0 },
+          "presets": [ { "name": "Warm", "saturation": 1, "tubeDrive": 5.5 } ] }
+
+    The factory bank (FactoryPresets.h) is parsed first. Its "defaults"
+    decide which parameters a preset sets and what each one gets when a
+    preset leaves it out. Every *.json in the preset folder is loaded after
+    it, in name order, and then the user presets in its User subfolder.
+    A bank's own "defaults" only apply to the presets in that bank.
+
+    Everything is parsed once, when the first plugin instance is created,
+    into one flat table of floats with a row per preset and a column per
+    parameter. Applying a preset reads one row, found by its index.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FactoryPresets.h"
+#include <vector>
+
+//==============================================================================
+/** Every preset known to the plugin. Shared between instances through a
+    juce::SharedResourcePointer, and only used on the message thread.
+*/
+class PresetBank
+{
+public:
+    /** The profile parameter's range, so there's a cap on the bank. */
+    static constexpr int maxPresets = 1024;
+
+    PresetBank()
+    {
+        loadBank (juce::String::fromUTF8 (FactoryPresets::bank), "factory bank");
+        jassert (getNumPresets() > 0); // the factory bank must parse
+
+        for (const auto& file : findBankFiles (getPresetDirectory()))
+            loadBank (file.loadFileAsString(), file.getFileName());
+
+        firstUserPreset = getNumPresets();
+
+        for (const auto& file : findBankFiles (getUserPresetDirectory()))
+            loadBank (file.loadFileAsString(), file.getFileName());
+    }
+
+    //==============================================================================
+    static juce::File getPresetDirectory()
+    {
+        return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+                  #if JUCE_MAC
+                   .getChildFile ("Application Support")
+                  #endif
+                   .getChildFile ("Static Currents")
+                   .getChildFile ("Presets");
+    }
+
+    static juce::File getUserPresetDirectory()  { return getPresetDirectory().getChildFile ("User"); }
+
+    //==============================================================================
+    int getNumPresets() const noexcept                          { return names.size(); }
+    const juce::String& getName (int index) const noexcept      { return names.getReference (index); }
+    bool isUserPreset (int index) const noexcept                { return index >= firstUserPreset && index < getNumPresets(); }
+
+    /** The parameters every preset sets, in column order. */
+    const juce::StringArray& getParameterIDs() const noexcept   { return columns; }
+    int getNumColumns() const noexcept                          { return columns.size(); }
+
+    /** The row of getNumColumns() values for a preset. */
+    const float* getValues (int index) const noexcept
+    {
+        jassert (juce::isPositiveAndBelow (index, getNumPresets()));
+        return table.data() + static_cast<size_t> (index) * static_cast<size_t> (getNumColumns());
+    }
+
+    /** -1 if there's no preset of that name. */
+    int indexOf (const juce::String& name) const
+    {
+        return indexByName.contains (name) ? indexByName[name] : -1;
+    }
+
+    //==============================================================================
+    /** Saves values (one per column) as a user preset. A user preset of the
+        same name is replaced. Returns its index, or -1 if it couldn't be
+        written or the bank is full.
+    */
+    int saveUserPreset (const juce::String& name, const std::vector<float>& values)
+    {
+        const auto trimmed = name.trim();
+        jassert (values.size() == static_cast<size_t> (getNumColumns()));
+
+        if (trimmed.isEmpty() || values.size() != static_cast<size_t> (getNumColumns()))
+            return -1;
+
+        const auto existing = names.indexOf (trimmed, false, firstUserPreset);
+
+        if (existing < 0 && getNumPresets() >= maxPresets)
+        {
+            DBG ("Preset bank is full - user preset not saved");
+            return -1;
+        }
+
+        auto* preset = new juce::DynamicObject();
+        preset->setProperty ("name", trimmed);
+
+        for (int column = 0; column < getNumColumns(); ++column)
+            preset->setProperty (columns[column], values[static_cast<size_t> (column)]);
+
+        auto* bank = new juce::DynamicObject();
+        bank->setProperty ("name", "User");
+        bank->setProperty ("presets", juce::Array<juce::var> { juce::var (preset) });
+
+        const auto directory = getUserPresetDirectory();
+        const auto file = directory.getChildFile (juce::File::createLegalFileName (trimmed) + ".json");
+
+        if (! directory.createDirectory() || ! file.replaceWithText (juce::JSON::toString (juce::var (bank))))
+        {
+            DBG ("ERROR: Failed to write user preset: " + file.getFullPathName());
+            return -1;
+        }
+
+        if (existing >= 0)
+        {
+            const auto row = static_cast<std::ptrdiff_t> (existing) * getNumColumns();
+            std::copy (values.begin(), values.end(), table.begin() + row);
+            return existing;
+        }
+
+        return add (trimmed, values);
+    }
+
+private:
+    //==============================================================================
+    static juce::Array<juce::File> findBankFiles (const juce::File& directory)
+    {
+        auto files = directory.findChildFiles (juce::File::findFiles, false, "*.json");
+        files.sort();
+        return files;
+    }
+
+    void loadBank (const juce::String& text, const juce::String& source)
+    {
+        juce::var json;
+        const auto result = juce::JSON::parse (text, json);
+        auto* bank = json.getDynamicObject();
+
+        if (result.failed() || bank == nullptr)
+        {
+            DBG ("Preset bank " + source + " not loaded: " + (result.failed() ? result.getErrorMessage() : "not a JSON object"));
+            return;
+        }
+
+        const auto& bankDefaults = bank->getProperty ("defaults");
+
+        // The first bank decides the columns
+        if (columns.isEmpty())
+        {
+            if (auto* defaults = bankDefaults.getDynamicObject())
+            {
+                for (const auto& property : defaults->getProperties())
+                {
+                    columns.add (property.name.toString());
+                    defaultValues.push_back (static_cast<float> (property.value));
+                }
+            }
+
+            if (columns.isEmpty())
+            {
+                DBG ("Preset bank " + source + " has no defaults");
+                return;
+            }
+        }
+
+        auto presetDefaults = defaultValues;
+        readValues (bankDefaults, presetDefaults, source);
+
+        if (auto* presets = bank->getProperty ("presets").getArray())
+        {
+            for (const auto& preset : *presets)
+            {
+                const auto name = preset.getProperty ("name", {}).toString().trim();
+
+                if (name.isEmpty())
+                {
+                    DBG ("Unnamed preset in " + source + " skipped");
+                    continue;
+                }
+
+                if (getNumPresets() >= maxPresets)
+                {
+                    DBG ("Preset bank is full - " + source + " only partly loaded");
+                    return;
+                }
+
+                auto values = presetDefaults;
+                readValues (preset, values, source);
+                add (name, values);
+            }
+        }
+    }
+
+    void readValues (const juce::var& object, std::vector<float>& values, const juce::String& source) const
+    {
+        if (auto* properties = object.getDynamicObject())
+        {
+            for (const auto& property : properties->getProperties())
+            {
+                const auto id = property.name.toString();
+                const auto column = columns.indexOf (id);
+
+                if (column >= 0)
+                    values[static_cast<size_t> (column)] = static_cast<float> (property.value);
+                else if (id != "name")
+                    DBG ("Preset parameter " + id + " in " + source + " isn't set by presets - ignored");
+            }
+        }
+    }
+
+    int add (const juce::String& name, const std::vector<float>& values)
+    {
+        const auto index = getNumPresets();
+
+        names.add (name);
+        table.insert (table.end(), values.begin(), values.end());
+
+        // The first preset of a name wins a lookup by name
+        if (! indexByName.contains (name))
+            indexByName.set (name, index);
+
+        return index;
+    }
+
+    //==============================================================================
+    juce::StringArray columns;
+    std::vector<float> defaultValues;
+
+    juce::StringArray names;
+    std::vector<float> table;      // getNumPresets() rows of getNumColumns() values
+    juce::HashMap<juce::String, int> indexByName;
+    int firstUserPreset = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBank)
+};
@@ -0,0 +1,537 @@
+/*
+  ==============================================================================
+
+    SampleExporter.h
+
+    Background export of samples through the effects chain.
+
+    An ExportJob renders one source in fixed-size chunks on a worker thread:
+    each chunk is copied from the shared SampleData (or read from the source
+    file), run through a private EffectsChain and streamed straight to the
+    AudioFormatWriter, so memory use depends on the chunk size rather than the
+    length of the file. Progress is published through an atomic for the
+    editor to poll, and cancelling between chunks removes the partial file.
+
+    SampleExporter runs a single job for the loaded sample; BatchExporter
+    fans a whole folder out over a pool with one thread per core, each job
+    with its own chain state, and summarises the throughput.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BufferSampler.h"
+#include "EffectsChain.h"
+
+//==============================================================================
+/** Renders one SampleData or audio file through an EffectsChain into a file. */
+class ExportJob  : public juce::ThreadPoolJob
+{
+public:
+    enum class State
+    {
+        pending,
+        running,
+        finished,
+        cancelled,
+        failed
+    };
+
+    /** Samples rendered and written per chunk. */
+    static constexpr int chunkSize = 32768;
+
+    ExportJob (SampleData::Ptr sourceToRender,
+               const ChainParameters& paramsToUse,
+               int processingBlockSize,
+               const juce::File& outputFile,
+               std::unique_ptr<juce::AudioFormat> formatToUse,
+               int bitsPerSample)
+        : juce::ThreadPoolJob ("Sample Export"),
+          destination (outputFile),
+          source (std::move (sourceToRender)),
+          sourceFile (juce::File()),
+          params (paramsToUse),
+          blockSize (juce::jmax (1, processingBlockSize)),
+          format (std::move (formatToUse)),
+          bitDepth (bitsPerSample)
+    {
+        jassert (source != nullptr && format != nullptr);
+    }
+
+    /** Streams the audio from a file instead, without loading it whole. */
+    ExportJob (const juce::File& fileToRender,
+               const ChainParameters& paramsToUse,
+               int processingBlockSize,
+               const juce::File& outputFile,
+               std::unique_ptr<juce::AudioFormat> formatToUse,
+               int bitsPerSample)
+        : juce::ThreadPoolJob ("Batch Export"),
+          destination (outputFile),
+          sourceFile (fileToRender),
+          params (paramsToUse),
+          blockSize (juce::jmax (1, processingBlockSize)),
+          format (std::move (formatToUse)),
+          bitDepth (bitsPerSample)
+    {
+        jassert (format != nullptr);
+    }
+
+    //==============================================================================
+    JobStatus runJob() override
+    {
+        state.store (State::running);
+        const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+        const auto result = render();
+
+        renderSeconds.store ((juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001);
+        state.store (result);
+
+        if (result != State::finished)
+            destination.deleteFile();
+
+        return jobHasFinished;
+    }
+
+    //==============================================================================
+    State getState() const noexcept         { return state.load(); }
+    bool isDone() const noexcept            { return getState() != State::pending && getState() != State::running; }
+    float getProgress() const noexcept      { return progress.load(); }
+
+    /** Wall-clock time spent rendering and encoding. */
+    double getRenderSeconds() const noexcept        { return renderSeconds.load(); }
+    double getSourceLengthSeconds() const noexcept  { return sourceLengthSeconds.load(); }
+
+    /** How many times faster than realtime the job ran, once finished. */
+    double getRealtimeMultiple() const noexcept
+    {
+        const auto seconds = getRenderSeconds();
+        return seconds > 0.0 ? getSourceLengthSeconds() / seconds : 0.0;
+    }
+
+    juce::String getSourceName() const
+    {
+        return source != nullptr ? juce::String ("Loaded sample") : sourceFile.getFileName();
+    }
+
+    const juce::File destination;
+
+private:
+    //==============================================================================
+    State render()
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader;
+
+        if (source == nullptr)
+        {
+            juce::AudioFormatManager formatManager;
+            formatManager.registerBasicFormats();
+            reader.reset (formatManager.createReaderFor (sourceFile));
+
+            if (reader == nullptr || reader->sampleRate <= 0.0)
+            {
+                DBG ("ERROR: Failed to create reader for " + sourceFile.getFullPathName());
+                return State::failed;
+            }
+        }
+
+        const int numChannels = source != nullptr ? source->audio.getNumChannels()
+                                                  : juce::jlimit (1, 2, static_cast<int> (reader->numChannels));
+        const juce::int64 numSamples = source != nullptr ? source->getNumSamples() : reader->lengthInSamples;
+        const double sampleRate = source != nullptr ? source->sampleRate : reader->sampleRate;
+
+        if (numSamples <= 0 || numChannels == 0)
+            return State::failed;
+
+        sourceLengthSeconds.store (static_cast<double> (numSamples) / sampleRate);
+
+        destination.deleteFile();
+        std::unique_ptr<juce::OutputStream> outputStream (destination.createOutputStream());
+
+        if (outputStream == nullptr)
+        {
+            DBG ("ERROR: Failed to create export output stream!");
+            return State::failed;
+        }
+
+        auto channelLayout = (numChannels == 1) ? juce::AudioChannelSet::mono() : juce::AudioChannelSet::stereo();
+
+        auto options = juce::AudioFormatWriterOptions{}
+                   .withSampleRate (sampleRate)
+                   .withChannelLayout (channelLayout)
+                   .withBitsPerSample (bitDepth);
+        auto writer = format->createWriterFor (outputStream, options);
+
+        if (writer == nullptr)
+        {
+            DBG ("ERROR: Failed to create export writer!");
+            return State::failed;
+        }
+
+        // A fresh chain per job, prepared exactly like the realtime one
+        EffectsChain chain;
+        chain.prepare (sampleRate, blockSize, numChannels, params);
+
+        // Compensate the chain's latency (compressor lookahead): run that many
+        // samples of silence past the end and drop the same amount at the start
+        const int latency = chain.getLatencySamples();
+        const juce::int64 totalSamples = numSamples + latency;
+        juce::int64 samplesToSkip = latency;
+
+        juce::AudioBuffer<float> chunk (numChannels, chunkSize);
+
+        for (juce::int64 position = 0; position < totalSamples; position += chunkSize)
+        {
+            if (shouldExit())
+                return State::cancelled;
+
+            const int numThisChunk = static_cast<int> (juce::jmin (static_cast<juce::int64> (chunkSize), totalSamples - position));
+            const int numFromSource = static_cast<int> (juce::jlimit (static_cast<juce::int64> (0), static_cast<juce::int64> (numThisChunk),
+                                                                      numSamples - position));
+
+            if (reader != nullptr)
+            {
+                // Reads past the end come back as silence
+                reader->read (&chunk, 0, numThisChunk, position, true, true);
+            }
+            else
+            {
+                chunk.clear();
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    chunk.copyFrom (ch, 0, source->audio, ch, static_cast<int> (position), numFromSource);
+            }
+
+            juce::AudioBuffer<float> block (chunk.getArrayOfWritePointers(), numChannels, 0, numThisChunk);
+            chain.processOffline (block, params);
+
+            const int skip = static_cast<int> (juce::jmin (samplesToSkip, static_cast<juce::int64> (numThisChunk)));
+            samplesToSkip -= skip;
+
+            if (! writer->writeFromAudioSampleBuffer (block, skip, numThisChunk - skip))
+            {
+                DBG ("ERROR: Failed writing export chunk!");
+                return State::failed;
+            }
+
+            progress.store (static_cast<float> (position + numThisChunk) / static_cast<float> (totalSamples));
+        }
+
+        // Flushes and closes the file
+        writer.reset();
+        return State::finished;
+    }
+
+    //==============================================================================
+    const SampleData::Ptr source;
+    const juce::File sourceFile;
+    const ChainParameters params;
+    const int blockSize;
+    std::unique_ptr<juce::AudioFormat> format;
+    const int bitDepth;
+
+    std::atomic<State> state { State::pending };
+    std::atomic<float> progress { 0.0f };
+    std::atomic<double> renderSeconds { 0.0 };
+    std::atomic<double> sourceLengthSeconds { 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ExportJob)
+};
+
+//==============================================================================
+/**
+    Owns the export worker and the current job. All methods are called from
+    the message thread; the editor polls getProgress()/getState() from its timer.
+*/
+class SampleExporter
+{
+public:
+    SampleExporter() = default;
+
+    ~SampleExporter()
+    {
+        pool.removeAllJobs (true, 4000);
+    }
+
+    //==============================================================================
+    /** Picks the audio format and bit depth for a file from its extension. */
+    static std::unique_ptr<juce::AudioFormat> createFormatFor (const juce::File& outputFile, int& bitDepth,
+                                                               bool warnIfUnavailable = true)
+    {
+        bitDepth = 24;
+
+        if (outputFile.hasFileExtension (".wav"))
+        {
+            // Check filename for bit depth hint
+            if (outputFile.getFileNameWithoutExtension().containsIgnoreCase ("16"))
+                bitDepth = 16;
+
+            return std::make_unique<juce::WavAudioFormat>();
+        }
+
+        if (outputFile.hasFileExtension (".mp3"))
+        {
+           #if JUCE_USE_LAME_AUDIO_FORMAT
+            bitDepth = 16;
+            return std::make_unique<juce::LAMEEncoderAudioFormat> (outputFile);
+           #else
+            // MP3 encoding not available - fall back to WAV
+            if (warnIfUnavailable)
+            {
+               #if STATIC_CURRENTS_HEADLESS
+                DBG ("MP3 encoding requires LAME library. Saving as WAV instead.");
+               #else
+                juce::AlertWindow::showMessageBoxAsync (juce::AlertWindow::WarningIcon,
+                    "MP3 Not Available",
+                    "MP3 encoding requires LAME library. Saving as WAV instead.");
+               #endif
+            }
+
+            return std::make_unique<juce::WavAudioFormat>();
+           #endif
+        }
+
+        if (outputFile.hasFileExtension (".ogg"))
+        {
+            bitDepth = 16; // OGG uses quality setting, not bit depth
+            return std::make_unique<juce::OggVorbisAudioFormat>();
+        }
+
+        if (outputFile.hasFileExtension (".flac"))
+            return std::make_unique<juce::FlacAudioFormat>();
+
+        // Default to WAV
+        return std::make_unique<juce::WavAudioFormat>();
+    }
+
+    //==============================================================================
+    /** Queues a job. Fails if an export is already running. */
+    bool start (std::unique_ptr<ExportJob> job)
+    {
+        if (job == nullptr || isRunning())
+            return false;
+
+        // The finished job may still be registered with the pool for a moment
+        if (currentJob != nullptr && ! pool.removeJob (currentJob.get(), false, 1000))
+            return false;
+
+        currentJob = std::move (job);
+        pool.addJob (currentJob.get(), false);
+        return true;
+    }
+
+    /** Asks the running job to stop after its current chunk. */
+    void cancel()
+    {
+        if (currentJob != nullptr)
+            currentJob->signalJobShouldExit();
+    }
+
+    bool isRunning() const noexcept         { return currentJob != nullptr && ! currentJob->isDone(); }
+    float getProgress() const noexcept      { return currentJob != nullptr ? currentJob->getProgress() : 0.0f; }
+
+    ExportJob::State getState() const noexcept
+    {
+        return currentJob != nullptr ? currentJob->getState() : ExportJob::State::pending;
+    }
+
+private:
+    juce::ThreadPool pool { 1 };
+    std::unique_ptr<ExportJob> currentJob;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleExporter)
+};
+
+//==============================================================================
+/**
+    Renders every audio file in a folder through the same chain settings, in
+    parallel. Each job owns its chain, so no DSP state is shared between
+    threads. Called from the message thread, polled like SampleExporter.
+*/
+class BatchExporter
+{
+public:
+    BatchExporter() = default;
+
+    ~BatchExporter()
+    {
+        pool.removeAllJobs (true, 4000);
+    }
+
+    //==============================================================================
+    /** Queues one job per audio file in sourceDirectory. Outputs are written
+        to outputDirectory with the given extension. Returns the number of
+        files queued (0 if a batch is already running or nothing was found).
+    */
+    int start (const juce::File& sourceDirectory, const juce::File& outputDirectory,
+               const juce::String& extension, const ChainParameters& params, int blockSize)
+    {
+        auto sources = sourceDirectory.findChildFiles (juce::File::findFiles, false, getSupportedWildcard());
+        sources.sort();
+
+        return start (sources, outputDirectory, extension, params, blockSize);
+    }
+
+    /** As above, for an explicit list of source files. */
+    int start (const juce::Array<juce::File>& sources, const juce::File& outputDirectory,
+               const juce::String& extension, const ChainParameters& params, int blockSize)
+    {
+        if (isRunning())
+            return 0;
+
+        // Finished jobs may still be registered with the pool for a moment
+        if (! pool.removeAllJobs (false, 1000))
+            return 0;
+
+        jobs.clear();
+
+        if (sources.isEmpty() || ! outputDirectory.createDirectory())
+            return 0;
+
+        destinationDirectory = outputDirectory;
+        batchStartTime = juce::Time::getMillisecondCounterHiRes();
+
+        // Warn about a missing MP3 encoder once, not once per file
+        int bitDepth = 24;
+        SampleExporter::createFormatFor (outputDirectory.getChildFile ("batch" + extension), bitDepth);
+
+        juce::StringArray outputNames;
+
+        for (auto& file : sources)
+        {
+            // Outputs of an earlier batch into the same folder aren't sources
+            if (file.getFileNameWithoutExtension().endsWith (outputSuffix))
+                continue;
+
+            // take.wav and take.flac would share an output, so a second one
+            // keeps its source's extension in the name
+            auto name = file.getFileNameWithoutExtension() + outputSuffix;
+
+            if (outputNames.contains (name, true))
+                name = file.getFileNameWithoutExtension() + "_" + file.getFileExtension().substring (1) + outputSuffix;
+
+            for (int n = 2; outputNames.contains (name, true); ++n)
+                name = file.getFileNameWithoutExtension() + "_" + juce::String (n) + outputSuffix;
+
+            outputNames.add (name);
+
+            auto outputFile = outputDirectory.getChildFile (name + extension);
+            auto format = SampleExporter::createFormatFor (outputFile, bitDepth, false);
+
+            jobs.push_back (std::make_unique<ExportJob> (file, params, blockSize, outputFile, std::move (format), bitDepth));
+        }
+
+        if (jobs.empty())
+            return 0;
+
+        for (auto& job : jobs)
+            pool.addJob (job.get(), false);
+
+        DBG ("Batch export: " + juce::String (static_cast<int> (jobs.size())) + " files on "
+             + juce::String (pool.getNumThreads()) + " threads");
+
+        return static_cast<int> (jobs.size());
+    }
+
+    static juce::String getSupportedWildcard()     { return "*.wav;*.aif;*.aiff;*.flac;*.ogg;*.mp3"; }
+
+    /** Ends the name of every output file (before its extension). */
+    static constexpr const char* outputSuffix = "_processed";
+
+    void cancel()
+    {
+        for (auto& job : jobs)
+            job->signalJobShouldExit();
+    }
+
+    bool isRunning() const noexcept
+    {
+        return std::any_of (jobs.begin(), jobs.end(), [] (const auto& job) { return ! job->isDone(); });
+    }
+
+    /** Overall progress, 0 to 1, weighting every file equally. */
+    float getProgress() const noexcept
+    {
+        if (jobs.empty())
+            return 0.0f;
+
+        float total = 0.0f;
+
+        for (auto& job : jobs)
+            total += job->isDone() ? 1.0f : job->getProgress();
+
+        return total / static_cast<float> (jobs.size());
+    }
+
+    int getNumFiles() const noexcept        { return static_cast<int> (jobs.size()); }
+
+    int getNumFinished() const noexcept
+    {
+        return static_cast<int> (std::count_if (jobs.begin(), jobs.end(),
+                                                [] (const auto& job) { return job->getState() == ExportJob::State::finished; }));
+    }
+
+    //==============================================================================
+    /** Per-file timing and overall throughput of the last batch, as text. */
+    juce::String createReport() const
+    {
+        juce::String report;
+        double totalAudio = 0.0, totalRender = 0.0;
+
+        report << "Static Currents batch export" << juce::newLine
+               << "Threads: " << pool.getNumThreads() << juce::newLine << juce::newLine;
+
+        for (auto& job : jobs)
+        {
+            report << job->getSourceName() << ": ";
+
+            switch (job->getState())
+            {
+                case ExportJob::State::finished:
+                    report << juce::String (job->getSourceLengthSeconds(), 2) << " s audio in "
+                           << juce::String (job->getRenderSeconds(), 3) << " s ("
+                           << juce::String (job->getRealtimeMultiple(), 1) << "x realtime)";
+                    totalAudio += job->getSourceLengthSeconds();
+                    totalRender += job->getRenderSeconds();
+                    break;
+                case ExportJob::State::cancelled:   report << "cancelled"; break;
+                case ExportJob::State::failed:      report << "FAILED"; break;
+                case ExportJob::State::pending:
+                case ExportJob::State::running:
+                default:                            report << "not finished"; break;
+            }
+
+            report << juce::newLine;
+        }
+
+        const double wallSeconds = (juce::Time::getMillisecondCounterHiRes() - batchStartTime) * 0.001;
+
+        report << juce::newLine
+               << "Files: " << getNumFinished() << " of " << getNumFiles() << " exported" << juce::newLine
+               << "Audio: " << juce::String (totalAudio, 2) << " s" << juce::newLine
+               << "CPU time: " << juce::String (totalRender, 3) << " s" << juce::newLine
+               << "Wall time: " << juce::String (wallSeconds, 3) << " s" << juce::newLine
+               << "Throughput: " << juce::String (wallSeconds > 0.0 ? totalAudio / wallSeconds : 0.0, 1)
+               << "x realtime" << juce::newLine;
+
+        return report;
+    }
+
+    /** Writes createReport() next to the exported files. */
+    juce::File writeReport() const
+    {
+        auto reportFile = destinationDirectory.getChildFile ("batch_export_report.txt");
+        reportFile.replaceWithText (createReport());
+        return reportFile;
+    }
+
+private:
+    juce::ThreadPool pool { juce::jmax (1, juce::SystemStats::getNumCpus()) };
+    std::vector<std::unique_ptr<ExportJob>> jobs;
+    juce::File destinationDirectory;
+    double batchStartTime = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BatchExporter)
+};
@@ -0,0 +1,375 @@
+/*
+  ==============================================================================
+
+    SampleRecorder.h
+
+    Streaming recorder with background finalization.
+
+    While recording, the audio thread pushes each block into a lock-free FIFO
+    (in the style of AudioFormatWriter::ThreadedWriter) and a shared writer
+    thread drains it. The writer thread optionally streams the take to disk
+    and keeps the playable head of it in memory, so memory use stays bounded
+    and takes can run for hours.
+
+    When a take stops, the audio thread hands it over through a single-slot
+    lock-free mailbox. The finalizer thread closes the file, moves the captured
+    audio straight into a BufferSamplerSound (no WAV decode) and publishes the
+    sound back with an atomic pointer swap, so the realtime callback never
+    blocks on the disk or the allocator.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BufferSampler.h"
+
+//==============================================================================
+class SampleRecorder  : private juce::Thread
+{
+public:
+    /** Longest take that is kept in memory for playback. Longer files are
+        streamed from disk instead (see SampleStreamer.h).
+    */
+    static constexpr double maxPlayableSeconds = 60.0;
+
+    //==============================================================================
+    /** A take in progress. Created on the message thread by createTake(),
+        written to by the audio thread, drained by the writer thread and then
+        handed over to the finalizer.
+    */
+    class Take  : private juce::TimeSliceClient
+    {
+    public:
+        Take (juce::TimeSliceThread& thread,
+              std::unique_ptr<juce::AudioFormatWriter> writerToUse,
+              const juce::File& file, int channels, double rate)
+            : numChannels (channels),
+              sampleRate (rate),
+              destination (file),
+              writerThread (thread),
+              fileWriter (std::move (writerToUse)),
+              fifo (fifoSizeInSamples (rate)),
+              maxCaptureSamples (static_cast<int> (rate * maxPlayableSeconds))
+        {
+            fifoBuffer.setSize (numChannels, fifo.getTotalSize());
+            writerThread.addTimeSliceClient (this);
+        }
+
+        ~Take() override
+        {
+            writerThread.removeTimeSliceClient (this);
+        }
+
+        /** Audio thread: queues a block for the writer thread. Never blocks;
+            if the writer falls behind, the block is dropped and counted.
+        */
+        void write (const float* const* channels, int numSamplesToWrite) noexcept
+        {
+            const auto scope = fifo.write (numSamplesToWrite);
+
+            if (scope.blockSize1 + scope.blockSize2 < numSamplesToWrite)
+            {
+                numDroppedSamples += numSamplesToWrite;
+                return;
+            }
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                if (scope.blockSize1 > 0)
+                    fifoBuffer.copyFrom (ch, scope.startIndex1, channels[ch], scope.blockSize1);
+
+                if (scope.blockSize2 > 0)
+                    fifoBuffer.copyFrom (ch, scope.startIndex2, channels[ch] + scope.blockSize1, scope.blockSize2);
+            }
+
+            numSamples += numSamplesToWrite;
+        }
+
+        /** Finalizer thread: stops the writer, drains the FIFO, closes the file
+            and hands back the captured audio.
+        */
+        SampleData::Ptr finish()
+        {
+            writerThread.removeTimeSliceClient (this);
+
+            while (drain() > 0) {}
+
+            fileWriter.reset();
+
+            if (numCaptured == 0)
+                return {};
+
+            // Shrinks the logical size only - the audio isn't copied
+            capture.setSize (numChannels, numCaptured, true, false, true);
+            return SampleData::adopt (std::move (capture), sampleRate);
+        }
+
+        juce::int64 getNumSamples() const noexcept          { return numSamples; }
+        juce::int64 getNumDroppedSamples() const noexcept   { return numDroppedSamples; }
+        bool isPersisted() const noexcept                   { return destination != juce::File(); }
+
+        const int numChannels;
+        const double sampleRate;
+        const juce::File destination;
+
+    private:
+        // Two seconds of headroom is plenty for the writer thread to keep up
+        static int fifoSizeInSamples (double rate)
+        {
+            return juce::jmax (32768, juce::nextPowerOfTwo (static_cast<int> (rate * 2.0)));
+        }
+
+        int useTimeSlice() override
+        {
+            return drain() > 0 ? 0 : 10;
+        }
+
+        int drain()
+        {
+            const auto scope = fifo.read (fifo.getNumReady());
+            consume (scope.startIndex1, scope.blockSize1);
+            consume (scope.startIndex2, scope.blockSize2);
+            return scope.blockSize1 + scope.blockSize2;
+        }
+
+        void consume (int start, int num)
+        {
+            if (num <= 0)
+                return;
+
+            if (fileWriter != nullptr)
+                fileWriter->writeFromAudioSampleBuffer (fifoBuffer, start, num);
+
+            // Keep the playable head in memory, growing on this thread only
+            const int toCapture = juce::jmin (num, maxCaptureSamples - numCaptured);
+
+            if (toCapture <= 0)
+                return;
+
+            if (numCaptured + toCapture > capture.getNumSamples())
+            {
+                const int newSize = juce::jmin (maxCaptureSamples,
+                                                juce::jmax (numCaptured + toCapture, capture.getNumSamples() * 2,
+                                                            static_cast<int> (sampleRate * 4.0)));
+                capture.setSize (numChannels, newSize, true, true, false);
+            }
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                capture.copyFrom (ch, numCaptured, fifoBuffer, ch, start, toCapture);
+
+            numCaptured += toCapture;
+        }
+
+        juce::TimeSliceThread& writerThread;
+        std::unique_ptr<juce::AudioFormatWriter> fileWriter;
+
+        juce::AbstractFifo fifo;
+        juce::AudioBuffer<float> fifoBuffer;
+
+        juce::AudioBuffer<float> capture;
+        int numCaptured = 0;
+        const int maxCaptureSamples;
+
+        juce::int64 numSamples = 0;
+        juce::int64 numDroppedSamples = 0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Take)
+    };
+
+    //==============================================================================
+    SampleRecorder()  : juce::Thread ("Recording Finalizer")
+    {
+        writerThread.startThread (juce::Thread::Priority::high);
+        startThread (juce::Thread::Priority::low);
+    }
+
+    ~SampleRecorder() override
+    {
+        stopThread (4000);
+
+        delete pendingTake.exchange (nullptr);
+        releaseSound (finishedSound.exchange (nullptr));
+        releaseSound (retiredSound.exchange (nullptr));
+
+        writerThread.stopThread (4000);
+    }
+
+    //==============================================================================
+    /** When disabled, takes are only kept in memory and no WAV is written. */
+    void setPersistToDisk (bool shouldPersist) noexcept     { persistToDisk.store (shouldPersist); }
+    bool isPersistingToDisk() const noexcept                { return persistToDisk.load(); }
+
+    /** Message thread: prepares a take, opening a streaming WAV writer for it
+        if disk persistence is enabled. Returns nullptr on failure.
+    */
+    std::unique_ptr<Take> createTake (const juce::File& destination, double sampleRate, int numChannels)
+    {
+        if (sampleRate <= 0.0 || numChannels <= 0)
+            return {};
+
+        if (! persistToDisk.load())
+            return std::make_unique<Take> (writerThread, nullptr, juce::File(), numChannels, sampleRate);
+
+        destination.deleteFile();
+        std::unique_ptr<juce::FileOutputStream> outStream (destination.createOutputStream());
+
+        if (outStream == nullptr)
+        {
+            DBG ("ERROR: Failed to create output stream!");
+            return {};
+        }
+
+        juce::WavAudioFormat wavFormat;
+        juce::StringPairArray metadata;
+        std::unique_ptr<juce::AudioFormatWriter> writer (
+            wavFormat.createWriterFor (outStream.get(), sampleRate, static_cast<unsigned int> (numChannels), 24, metadata, 0));
+
+        if (writer == nullptr)
+        {
+            DBG ("ERROR: Failed to create WAV writer!");
+            return {};
+        }
+
+        outStream.release();
+        return std::make_unique<Take> (writerThread, std::move (writer), destination, numChannels, sampleRate);
+    }
+
+    /** Audio thread: passes ownership of a finished take to the finalizer.
+        Returns false (and leaves the take with the caller) if the previous take
+        is still waiting to be picked up, so the caller can retry next block.
+    */
+    bool submit (std::unique_ptr<Take>& take) noexcept
+    {
+        Take* expected = nullptr;
+
+        if (! pendingTake.compare_exchange_strong (expected, take.get()))
+            return false;
+
+        take.release();
+        busy.store (true);
+        return true;
+    }
+
+    /** Audio thread: claims the most recently finalized sound, or nullptr.
+        The caller receives one reference which it must drop with
+        decReferenceCountWithoutDeleting() once the sound is owned elsewhere.
+    */
+    juce::SynthesiserSound* takeFinishedSound() noexcept
+    {
+        if (finishedSound.load (std::memory_order_relaxed) == nullptr)
+            return nullptr;
+
+        return finishedSound.exchange (nullptr);
+    }
+
+    /** Audio thread: hands a sound that is being replaced to the finalizer, so
+        that its (potentially large) sample data is freed off the callback.
+    */
+    void retire (juce::SynthesiserSound* sound) noexcept
+    {
+        if (sound == nullptr)
+            return;
+
+        sound->incReferenceCount();
+
+        // The finalizer reaps this slot before it can publish another sound,
+        // so it should always be empty by the time a new sound is installed.
+        auto* previous = retiredSound.exchange (sound);
+        jassert (previous == nullptr);
+        juce::ignoreUnused (previous);
+    }
+
+    /** True from the moment a take is submitted until its sound is claimed. */
+    bool isBusy() const noexcept            { return busy.load() || finishedSound.load() != nullptr; }
+
+    /** The last take successfully written to disk. */
+    juce::File getLastWrittenFile() const
+    {
+        const juce::ScopedLock sl (lastTakeLock);
+        return lastWrittenFile;
+    }
+
+    /** The audio of the last finalized take, shared rather than copied. */
+    SampleData::Ptr getLastRecording() const
+    {
+        const juce::ScopedLock sl (lastTakeLock);
+        return lastRecording;
+    }
+
+private:
+    //==============================================================================
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            releaseSound (retiredSound.exchange (nullptr));
+
+            if (std::unique_ptr<Take> take { pendingTake.exchange (nullptr) })
+            {
+                finalize (*take);
+                busy.store (false);
+            }
+
+            wait (20);
+        }
+    }
+
+    void finalize (Take& take)
+    {
+        DBG ("Finalizing recording: " + juce::String (take.getNumSamples()) + " samples, "
+             + juce::String (take.getNumDroppedSamples()) + " dropped");
+
+        auto recording = take.finish();
+
+        if (recording == nullptr)
+        {
+            DBG ("No audio recorded - nothing to finalize");
+            take.destination.deleteFile();
+            return;
+        }
+
+        {
+            const juce::ScopedLock sl (lastTakeLock);
+            lastRecording = recording;
+
+            if (take.isPersisted())
+                lastWrittenFile = take.destination;
+        }
+
+        juce::BigInteger allNotes;
+        allNotes.setRange (0, 128, true);
+
+        auto* sound = new BufferSamplerSound ("Sample", std::move (recording), allNotes,
+                                              60,   // root note (middle C)
+                                              0.0,  // no attack envelope (play full sample)
+                                              0.0   // no release envelope (play full sample)
+                                              );
+        sound->incReferenceCount();
+
+        // An unclaimed older sound is simply superseded
+        releaseSound (finishedSound.exchange (sound));
+    }
+
+    static void releaseSound (juce::SynthesiserSound* sound)
+    {
+        if (sound != nullptr)
+            sound->decReferenceCount();
+    }
+
+    //==============================================================================
+    juce::TimeSliceThread writerThread { "Recording Writer" };
+    std::atomic<bool> persistToDisk { true };
+
+    std::atomic<Take*> pendingTake { nullptr };
+    std::atomic<juce::SynthesiserSound*> finishedSound { nullptr };
+    std::atomic<juce::SynthesiserSound*> retiredSound { nullptr };
+    std::atomic<bool> busy { false };
+
+    juce::CriticalSection lastTakeLock;
+    juce::File lastWrittenFile;
+    SampleData::Ptr lastRecording;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleRecorder)
+};
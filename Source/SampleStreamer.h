@@ -0,0 +1,215 @@
+/*
+  ==============================================================================
+
+    SampleStreamer.h
+
+    Direct-from-disk playback for samples too long to hold in memory.
+
+    A DiskSampleSource keeps the file open and gives every sampler voice its
+    own SampleStream: a fixed-size ring that a background TimeSliceThread
+    refills from the file ahead of the voice. The sound keeps the head of the
+    file in memory (see BufferSamplerSound). A note therefore starts at once
+    and the ring only has to take over after headSeconds. Memory use is the
+    head plus one ring per voice, however long the file is.
+
+    WAV and AIFF files are memory-mapped where the format allows it. Only the
+    reader thread touches the mapping, so page faults never reach the audio
+    thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    One voice's window onto a streamed file. The voice (audio thread) says
+    where it wants to read from and how far it has got. The reader thread
+    fills the ring up to a ring's length ahead of that.
+
+    A start() drops whatever was buffered. Until the reader has caught up with
+    it, getReadyEnd() returns -1 and the voice plays silence.
+*/
+class SampleStream
+{
+public:
+    static constexpr int ringFrames = 1 << 15;      // a power of two, so a frame's slot is a mask
+    static constexpr int chunkFrames = 4096;        // frames read per pass of the reader thread
+
+    SampleStream()  : ring (2, ringFrames)
+    {
+        ring.clear();
+    }
+
+    //==============================================================================
+    /** Voice: starts streaming from a frame of the file. */
+    void start (juce::int64 frame) noexcept
+    {
+        consumed.store (frame);
+        startFrame.store (frame);
+        requestedGeneration.store (++generation);
+        active.store (true);
+    }
+
+    /** Voice: stops the reader filling this stream. */
+    void stop() noexcept                                { active.store (false); }
+
+    /** Voice: frames before this one won't be read again, so their slots can be refilled. */
+    void release (juce::int64 frame) noexcept           { consumed.store (frame); }
+
+    /** Voice: the end of the frames that are ready, or -1 while a start() is
+        still being serviced. Frames from the last release() up to it can be
+        read with getFrame().
+    */
+    juce::int64 getReadyEnd() const noexcept
+    {
+        if (filledGeneration.load() != generation)
+            return -1;
+
+        return written.load();
+    }
+
+    void getFrame (juce::int64 frame, float& l, float& r) const noexcept
+    {
+        const auto slot = static_cast<int> (frame & (ringFrames - 1));
+        l = ring.getSample (0, slot);
+        r = ring.getSample (1, slot);
+    }
+
+    //==============================================================================
+    bool isActive() const noexcept                      { return active.load(); }
+
+    /** Reader thread: reads one chunk into the ring. Returns true if there's
+        more to read straight away.
+    */
+    bool fill (juce::AudioFormatReader& reader, juce::int64 length)
+    {
+        if (! active.load())
+            return false;
+
+        const auto requested = requestedGeneration.load();
+
+        if (requested != filledGeneration.load())
+        {
+            written.store (startFrame.load());
+            filledGeneration.store (requested);
+        }
+
+        // After an underrun the voice is ahead of the ring, so skip to it
+        const auto from = juce::jmax (written.load(), consumed.load());
+        const auto to = juce::jmin (length, consumed.load() + ringFrames);
+
+        if (from >= to)
+            return false;
+
+        const auto numFrames = static_cast<int> (juce::jmin (to - from, static_cast<juce::int64> (chunkFrames)));
+        const auto slot = static_cast<int> (from & (ringFrames - 1));
+        const auto firstPart = juce::jmin (numFrames, ringFrames - slot);
+
+        // A mono file is read into both channels
+        reader.read (&ring, slot, firstPart, from, true, true);
+
+        if (firstPart < numFrames)
+            reader.read (&ring, 0, numFrames - firstPart, from + firstPart, true, true);
+
+        written.store (from + numFrames);
+        return from + numFrames < to;
+    }
+
+private:
+    juce::AudioBuffer<float> ring;
+
+    juce::uint32 generation = 0;                        // the voice's own count of start()s
+    std::atomic<juce::uint32> requestedGeneration { 0 }, filledGeneration { 0 };
+    std::atomic<juce::int64> startFrame { 0 }, consumed { 0 }, written { 0 };
+    std::atomic<bool> active { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleStream)
+};
+
+//==============================================================================
+/**
+    An open sample file with a SampleStream per voice, serviced by a
+    TimeSliceThread. It's shared by reference count between the sound that
+    plays it and nothing else. It is created and destroyed off the audio
+    thread.
+*/
+class DiskSampleSource  : private juce::TimeSliceClient
+{
+public:
+    using Ptr = std::shared_ptr<DiskSampleSource>;
+
+    /** How much of the file the sound keeps in memory. */
+    static constexpr double headSeconds = 1.0;
+
+    DiskSampleSource (std::unique_ptr<juce::AudioFormatReader> fileReader,
+                      int numStreams,
+                      juce::TimeSliceThread& thread)
+        : reader (std::move (fileReader)),
+          readerThread (thread)
+    {
+        jassert (reader != nullptr);
+
+        for (int i = 0; i < numStreams; ++i)
+            streams.add (new SampleStream());
+
+        readerThread.addTimeSliceClient (this);
+    }
+
+    ~DiskSampleSource() override
+    {
+        // Waits for a fill that's under way
+        readerThread.removeTimeSliceClient (this);
+    }
+
+    /** A reader for streaming: memory-mapped if the file's format supports it. */
+    static std::unique_ptr<juce::AudioFormatReader> createReader (juce::AudioFormatManager& formatManager,
+                                                                  const juce::File& file)
+    {
+        if (auto* format = formatManager.findFormatForFileExtension (file.getFileExtension()))
+        {
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped (format->createMemoryMappedReader (file));
+
+            if (mapped != nullptr && mapped->mapEntireFile() && ! mapped->getMappedSection().isEmpty())
+                return mapped;
+        }
+
+        return std::unique_ptr<juce::AudioFormatReader> (formatManager.createReaderFor (file));
+    }
+
+    //==============================================================================
+    juce::int64 getLengthInSamples() const noexcept     { return reader->lengthInSamples; }
+    double getSampleRate() const noexcept               { return reader->sampleRate; }
+    int getNumStreams() const noexcept                  { return streams.size(); }
+
+    SampleStream& getStream (int index) const noexcept
+    {
+        jassert (juce::isPositiveAndBelow (index, getNumStreams()));
+        return *streams.getUnchecked (index);
+    }
+
+private:
+    //==============================================================================
+    int useTimeSlice() override
+    {
+        bool anyActive = false, moreToRead = false;
+
+        // A chunk per stream per pass, so one voice can't starve the others
+        for (auto* stream : streams)
+        {
+            anyActive = stream->isActive() || anyActive;
+            moreToRead = stream->fill (*reader, getLengthInSamples()) || moreToRead;
+        }
+
+        return moreToRead ? 1 : (anyActive ? 5 : 20);
+    }
+
+    //==============================================================================
+    const std::unique_ptr<juce::AudioFormatReader> reader;   // only read by the thread after construction
+    juce::OwnedArray<SampleStream> streams;
+    juce::TimeSliceThread& readerThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DiskSampleSource)
+};
@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+    SamplerCommands.h
+
+    Transport and sample changes for the audio thread.
+
+    The editor never touches the sampler directly. It posts typed commands
+    (play, stop, seek, swap sound) into a single-producer/single-consumer
+    ring. At the start of each block the audio thread drains the ring and
+    applies the commands in order. Play and stop land at their sample
+    offset within the block. The sampler is therefore only changed on the
+    audio thread, and a burst of commands, for example stop then play,
+    arrives together in one block instead of racing a render.
+
+    A swapped-out sound can hold a minute of audio, so the audio thread
+    doesn't free it. It goes back through a second ring, and the producer
+    side releases it on its next post(), or from a message-thread timer
+    if no command follows soon.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+//==============================================================================
+/** A fixed-capacity ring with one producer and one consumer thread. */
+template <typename Item, int capacity>
+class SpscRing
+{
+public:
+    /** Producer: false if the ring is full. */
+    bool push (const Item& item) noexcept
+    {
+        const auto scope = fifo.write (1);
+
+        if (scope.blockSize1 == 0)
+            return false;
+
+        items[static_cast<size_t> (scope.startIndex1)] = item;
+        return true;
+    }
+
+    /** Consumer: false if the ring is empty. */
+    bool pop (Item& item) noexcept
+    {
+        const auto scope = fifo.read (1);
+
+        if (scope.blockSize1 == 0)
+            return false;
+
+        item = items[static_cast<size_t> (scope.startIndex1)];
+        return true;
+    }
+
+private:
+    // AbstractFifo keeps one slot free to tell full from empty
+    juce::AbstractFifo fifo { capacity + 1 };
+    std::array<Item, capacity + 1> items {};
+};
+
+//==============================================================================
+/** One command for the audio thread's sampler. */
+struct SamplerCommand
+{
+    enum class Type { play, stop, seek, swapSound };
+
+    Type type = Type::stop;
+    int sampleOffset = 0;                       // where it lands in the block that applies it
+    float seconds = 0.0f;                       // seek: position in the sample
+    juce::SynthesiserSound* sound = nullptr;    // swapSound: one reference, or nullptr to clear
+
+    static SamplerCommand play (int offset = 0) noexcept    { return { Type::play, offset }; }
+    static SamplerCommand stop (int offset = 0) noexcept    { return { Type::stop, offset }; }
+
+    static SamplerCommand seek (float positionInSeconds) noexcept
+    {
+        return { Type::seek, 0, positionInSeconds };
+    }
+
+    /** Takes a reference to the sound, which the audio thread adopts. */
+    static SamplerCommand swapSound (juce::SynthesiserSound* newSound) noexcept
+    {
+        if (newSound != nullptr)
+            newSound->incReferenceCount();
+
+        return { Type::swapSound, 0, 0.0f, newSound };
+    }
+};
+
+//==============================================================================
+/** The editor-to-audio-thread command ring and its way back for old sounds.
+    Several threads may post: they are serialised among themselves, so the
+    ring still has one producer at a time and the audio thread never waits.
+*/
+class SamplerCommandQueue  : private juce::Timer
+{
+public:
+    static constexpr int capacity = 64;
+
+    SamplerCommandQueue()
+    {
+        startTimer (500);
+    }
+
+    ~SamplerCommandQueue() override
+    {
+        stopTimer();
+
+        SamplerCommand command;
+
+        while (commands.pop (command))
+            release (command.sound);
+
+        collectGarbage();
+    }
+
+    /** Any thread but the audio thread. Returns false, and drops the command,
+        if the audio thread has fallen that far behind.
+    */
+    bool post (const SamplerCommand& command)
+    {
+        const juce::ScopedLock sl (postLock);
+
+        collectGarbage();
+
+        if (commands.push (command))
+            return true;
+
+        DBG ("Sampler command queue full - command dropped");
+        release (command.sound);
+        return false;
+    }
+
+    /** Audio thread: the next command, if there is one. */
+    bool next (SamplerCommand& command) noexcept
+    {
+        return commands.pop (command);
+    }
+
+    /** Audio thread: hands a sound that is being swapped out to the producer
+        side, so that its sample data is freed off the callback.
+    */
+    void retire (juce::SynthesiserSound* sound) noexcept
+    {
+        if (sound == nullptr)
+            return;
+
+        sound->incReferenceCount();
+
+        // Holds as many sounds as there can be swaps in flight, so it can't
+        // fill unless retire() is called without a swap
+        const auto retired = retiredSounds.push (sound);
+        jassert (retired);
+        juce::ignoreUnused (retired);
+    }
+
+private:
+    // Releases a swapped-out sound without waiting for the next command
+    void timerCallback() override
+    {
+        const juce::ScopedLock sl (postLock);
+        collectGarbage();
+    }
+
+    // The producer releases what the audio thread has swapped out
+    void collectGarbage()
+    {
+        juce::SynthesiserSound* sound = nullptr;
+
+        while (retiredSounds.pop (sound))
+            release (sound);
+    }
+
+    static void release (juce::SynthesiserSound* sound)
+    {
+        if (sound != nullptr)
+            sound->decReferenceCount();
+    }
+
+    SpscRing<SamplerCommand, capacity> commands;
+    SpscRing<juce::SynthesiserSound*, capacity> retiredSounds;
+    juce::CriticalSection postLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplerCommandQueue)
+};
@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+
+    SamplerEngine.h
+
+    The instrument's voice engine: a juce::Synthesiser of BufferSamplerVoices
+    with continuous pitch, a polyphony limit and voice stealing that backs
+    off when the audio callback runs short of time.
+
+    Every voice reads the same shared SampleData, so a voice costs its
+    playback state only (and, for a sample streamed from disk, its ring),
+    and an idle voice costs nothing to render. All of
+    the engine's voices are allocated up front. The polyphony limit decides
+    how many of them may sound at once. A note beyond the limit steals the
+    least audible voice: a voice already released, or the quietest one.
+    The stolen voice fades out over a few milliseconds (see
+    BufferSamplerVoice).
+
+    The processor times the engine's own rendering and reports that load
+    each block. While it stays high, the limit drops below the voices that
+    are sounding, a voice at a time, so dense MIDI thins out instead of
+    dropping out. A voice comes back once the load, plus one more voice's
+    share of it, fits again. Load from the rest of the plugin isn't
+    counted, so a heavy effects chain doesn't cost any voices.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BufferSampler.h"
+
+//==============================================================================
+/** Owned and driven by the audio thread only. */
+class SamplerEngine  : public juce::Synthesiser
+{
+public:
+    static constexpr int maxVoices = 32;
+
+    SamplerEngine()
+    {
+        // Each voice reads its own stream of a streamed sound
+        for (int i = 0; i < maxVoices; ++i)
+            addVoice (new BufferSamplerVoice (i));
+
+        // The engine's one sound slot, filled with silence while it has no sample
+        addSound (noSound.get());
+
+        setNoteStealingEnabled (true);
+    }
+
+    //==============================================================================
+    /** Puts newSound (or nothing, for nullptr) in the engine's sound slot.
+        Emptying a ReferenceCountedArray frees its storage, and refilling it
+        allocates, so the slot is swapped in place instead. Voices still
+        playing the old sound must have been stopped first.
+    */
+    void replaceSound (juce::SynthesiserSound* newSound)
+    {
+        const juce::ScopedLock sl (lock);
+        sounds.set (0, newSound != nullptr ? newSound : noSound.get());
+    }
+
+    /** The sound in the slot, or nullptr if there is none. */
+    juce::SynthesiserSound* getCurrentSound() const
+    {
+        auto* sound = sounds.getUnchecked (0).get();
+        return sound != noSound.get() ? sound : nullptr;
+    }
+
+    //==============================================================================
+    /** Call once per block before rendering.
+        polyphony:    the most voices allowed to sound at once
+        pitch:        playback rate for every voice (0.5 = an octave down)
+        renderLoad:   the share of the block's time that rendering the voices
+                      has recently taken
+    */
+    void beginBlock (int polyphony, double pitch, double renderLoad)
+    {
+        polyphonyLimit = juce::jlimit (1, maxVoices, polyphony);
+        updateLoadLimit (renderLoad);
+
+        for (auto* voice : voices)
+            static_cast<BufferSamplerVoice*> (voice)->setPlaybackRate (pitch);
+
+        // Voices over the limit (it may just have dropped) are cut, quietest first
+        const juce::ScopedLock sl (lock);
+
+        for (int excess = getNumSoundingVoices() - getVoiceLimit(); excess > 0; --excess)
+            if (auto* voice = findVoiceToSteal (nullptr, 0, -1))
+                voice->stopNote (0.0f, false);
+    }
+
+    /** The current limit: the polyphony, less any voices given up to load. */
+    int getVoiceLimit() const noexcept      { return juce::jmin (polyphonyLimit, loadLimit); }
+
+    /** Cancels every cut voice's fade. Needed before the sounds are replaced. */
+    void clearCutFades()
+    {
+        for (auto* voice : voices)
+            static_cast<BufferSamplerVoice*> (voice)->clearCutFade();
+    }
+
+protected:
+    //==============================================================================
+    juce::SynthesiserVoice* findFreeVoice (juce::SynthesiserSound* soundToPlay, int midiChannel,
+                                           int midiNoteNumber, bool stealIfNoneAvailable) const override
+    {
+        juce::SynthesiserVoice* freeVoice = nullptr;
+
+        for (auto* voice : voices)
+        {
+            if (! voice->isVoiceActive() && voice->canPlaySound (soundToPlay))
+            {
+                freeVoice = voice;
+                break;
+            }
+        }
+
+        if (freeVoice != nullptr && getNumSoundingVoices() < getVoiceLimit())
+            return freeVoice;
+
+        return stealIfNoneAvailable ? findVoiceToSteal (soundToPlay, midiChannel, midiNoteNumber) : nullptr;
+    }
+
+    juce::SynthesiserVoice* findVoiceToSteal (juce::SynthesiserSound* soundToPlay, int,
+                                              int midiNoteNumber) const override
+    {
+        juce::SynthesiserVoice* best = nullptr;
+        float bestLevel = 0.0f;
+
+        for (auto* voice : voices)
+        {
+            if (! voice->isVoiceActive() || (soundToPlay != nullptr && ! voice->canPlaySound (soundToPlay)))
+                continue;
+
+            // Retriggering a key takes over the voice already playing it
+            if (voice->getCurrentlyPlayingNote() == midiNoteNumber)
+                return voice;
+
+            // A released voice is on its way out, so it counts as quieter
+            auto level = static_cast<BufferSamplerVoice*> (voice)->getLevel();
+
+            if (voice->isPlayingButReleased())
+                level *= 0.5f;
+
+            if (best == nullptr || level < bestLevel
+                 || (level == bestLevel && voice->wasStartedBefore (*best)))
+            {
+                best = voice;
+                bestLevel = level;
+            }
+        }
+
+        return best;
+    }
+
+private:
+    //==============================================================================
+    int getNumSoundingVoices() const noexcept
+    {
+        int count = 0;
+
+        for (auto* voice : voices)
+            if (voice->isVoiceActive())
+                ++count;
+
+        return count;
+    }
+
+    // Over highLoad the limit drops to one below the voices sounding. A voice
+    // comes back while the load plus one more voice's share (estimated from
+    // those sounding) stays under recoverLoad. Either happens at most every
+    // adjustBlocks blocks, so the limit doesn't chatter.
+    void updateLoadLimit (double renderLoad) noexcept
+    {
+        static constexpr double highLoad = 0.6, recoverLoad = 0.5;
+        static constexpr int adjustBlocks = 8;
+
+        if (++blocksSinceAdjust < adjustBlocks)
+            return;
+
+        const int sounding = getNumSoundingVoices();
+        const double loadPerVoice = sounding > 0 ? renderLoad / sounding : 0.0;
+
+        if (renderLoad > highLoad && sounding > 1)
+        {
+            loadLimit = juce::jmin (loadLimit, sounding - 1);
+            blocksSinceAdjust = 0;
+        }
+        else if (renderLoad + loadPerVoice < recoverLoad && loadLimit < maxVoices)
+        {
+            ++loadLimit;
+            blocksSinceAdjust = 0;
+        }
+    }
+
+    // Fills the sound slot while there's no sample; it plays no notes
+    struct NoSound  : public juce::SynthesiserSound
+    {
+        bool appliesToNote (int) override       { return false; }
+        bool appliesToChannel (int) override    { return false; }
+    };
+
+    const juce::SynthesiserSound::Ptr noSound { new NoSound() };
+
+    int polyphonyLimit = 8;
+    int loadLimit = maxVoices;
+    int blocksSinceAdjust = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplerEngine)
+};
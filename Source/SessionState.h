@@ -0,0 +1,341 @@
+/*
+  ==============================================================================
+
+    SessionState.h
+
+    Saving and recalling a whole session: the parameter tree and the loaded
+    sample.
+
+    The state is a small binary container. It holds a header, the parameter
+    tree as a binary ValueTree, and then the sample. The sample is either
+    embedded as FLAC or saved as a reference to the file it was loaded from.
+
+    Encoding a minute of stereo audio to FLAC inside getStateInformation()
+    would stall the host's message thread on every project save. Instead,
+    SampleEncoder encodes each new sample on a background thread, a slice at
+    a time, as soon as the sample is loaded, recorded or jumbled. A save
+    then only copies the finished FLAC. If a save arrives mid-encode, the
+    remaining slices are finished on the saving thread.
+
+    The FLAC is 24-bit integer, so it can't hold float samples past 0 dBFS.
+    A hotter sample (a jumble, or a float file) is scaled down to peak at
+    full scale before encoding. The gain that restores it is stored next to
+    the FLAC.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BufferSampler.h"
+#include "SampleRecorder.h"
+
+//==============================================================================
+/** Keeps an up-to-date FLAC encoding of the session's sample, along with
+    the gain that restores its level.
+*/
+class SampleEncoder  : private juce::TimeSliceClient
+{
+public:
+    /** currentSample is polled from the encoder thread for the sample to
+        have ready, so it must be safe to call from any thread.
+    */
+    explicit SampleEncoder (std::function<SampleData::Ptr()> currentSampleToEncode)
+        : currentSample (std::move (currentSampleToEncode))
+    {
+        thread.addTimeSliceClient (this);
+        thread.startThread (juce::Thread::Priority::background);
+    }
+
+    ~SampleEncoder() override
+    {
+        thread.removeTimeSliceClient (this);
+        thread.stopThread (4000);
+    }
+
+    /** Calls use with the FLAC for data and the gain to apply when it's
+        decoded, finishing the encode on the calling thread first if the
+        background thread hasn't. Returns false, without calling use, if data
+        can't be encoded.
+    */
+    template <typename Callback>
+    bool useEncoded (const SampleData::Ptr& data, Callback&& use)
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (job.data != data)
+            start (data);
+
+        while (encodeSlice()) {}
+
+        if (! job.complete)
+            return false;
+
+        use (static_cast<const juce::MemoryBlock&> (job.encoded), job.gain);
+        return true;
+    }
+
+    /** Takes FLAC known to decode to data, e.g. from a recalled session, so
+        that data isn't encoded again.
+    */
+    void adopt (SampleData::Ptr data, juce::MemoryBlock&& flac, float gain)
+    {
+        const juce::ScopedLock sl (lock);
+
+        job.writer.reset();
+        job.data = std::move (data);
+        job.encoded = std::move (flac);
+        job.gain = gain;
+        job.position = job.data != nullptr ? job.data->getNumSamples() : 0;
+        job.complete = job.data != nullptr && ! job.encoded.isEmpty();
+    }
+
+private:
+    //==============================================================================
+    // A second or so of audio per slice keeps each slice short
+    static constexpr int sliceSamples = 1 << 16;
+
+    int useTimeSlice() override
+    {
+        // Ask before locking: the callback takes the processor's lock
+        auto latest = currentSample();
+
+        const juce::ScopedLock sl (lock);
+
+        if (latest != job.data)
+            start (std::move (latest));
+
+        return encodeSlice() ? 0 : 200;
+    }
+
+    void start (SampleData::Ptr data)
+    {
+        // The writer owns a stream into job.encoded, so it goes first
+        job.writer.reset();
+        job.encoded.reset();
+        job.position = 0;
+        job.complete = false;
+        job.gain = 1.0f;
+        job.data = std::move (data);
+
+        if (job.data == nullptr || job.data->getNumSamples() == 0)
+            return;
+
+        const auto& audio = job.data->audio;
+        const auto peak = audio.getMagnitude (0, audio.getNumSamples());
+
+        if (peak > 1.0f && std::isfinite (peak))
+        {
+            job.gain = peak;
+            job.slice.setSize (audio.getNumChannels(), sliceSamples, false, false, true);
+        }
+
+        auto stream = std::make_unique<juce::MemoryOutputStream> (job.encoded, false);
+
+        juce::FlacAudioFormat flacFormat;
+        juce::StringPairArray metadata;
+        job.writer.reset (flacFormat.createWriterFor (stream.get(), job.data->sampleRate,
+                                                      static_cast<unsigned int> (job.data->audio.getNumChannels()),
+                                                      24, metadata, 5));
+
+        if (job.writer == nullptr)
+        {
+            DBG ("ERROR: Failed to create FLAC writer for the session sample!");
+            return;
+        }
+
+        stream.release(); // the writer owns it now
+    }
+
+    // Returns true while there's more left to encode
+    bool encodeSlice()
+    {
+        if (job.writer == nullptr)
+            return false;
+
+        const auto& audio = job.data->audio;
+        const int numToWrite = juce::jmin (sliceSamples, audio.getNumSamples() - job.position);
+
+        auto written = false;
+
+        if (job.gain != 1.0f)
+        {
+            // Scaled a slice at a time, so a hot sample isn't copied whole
+            for (int ch = 0; ch < audio.getNumChannels(); ++ch)
+                job.slice.copyFrom (ch, 0, audio, ch, job.position, numToWrite, 1.0f / job.gain);
+
+            written = job.writer->writeFromAudioSampleBuffer (job.slice, 0, numToWrite);
+        }
+        else
+        {
+            written = job.writer->writeFromAudioSampleBuffer (audio, job.position, numToWrite);
+        }
+
+        if (! written)
+        {
+            DBG ("ERROR: FLAC encoding of the session sample failed!");
+            job.writer.reset();
+            job.encoded.reset();
+            return false;
+        }
+
+        job.position += numToWrite;
+
+        if (job.position < audio.getNumSamples())
+            return true;
+
+        // Deleting the writer flushes the last frames into job.encoded
+        job.writer.reset();
+        job.complete = true;
+        return false;
+    }
+
+    //==============================================================================
+    struct Job
+    {
+        SampleData::Ptr data;
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+        juce::MemoryBlock encoded;
+        juce::AudioBuffer<float> slice;   // the scaled slice, for a sample past full scale
+        float gain = 1.0f;                // what the decoded FLAC is multiplied by
+        int position = 0;
+        bool complete = false;
+    };
+
+    std::function<SampleData::Ptr()> currentSample;
+    juce::CriticalSection lock;
+    Job job;
+
+    juce::TimeSliceThread thread { "Session Sample Encoder" };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleEncoder)
+};
+
+//==============================================================================
+/** The contents of the processor's state block. */
+struct SessionState
+{
+    juce::ValueTree parameters;
+    SampleData::Ptr sample;
+    juce::MemoryBlock sampleFlac;   // set by read() when the sample was embedded
+    float sampleGain = 1.0f;        // the gain read() applied to sampleFlac
+    juce::File sampleFile;          // where the sample was loaded from, if anywhere
+
+    /** Writes the container. The sample is embedded, unless embedSample is
+        false and sampleFile still exists, in which case only the file is
+        referenced. A sampleFile without a sample is one that is streamed
+        from disk, and is always referenced.
+    */
+    void write (juce::OutputStream& stream, SampleEncoder& encoder, bool embedSample) const
+    {
+        stream.writeInt (magic);
+        stream.writeInt (currentVersion);
+
+        juce::MemoryOutputStream tree;
+        parameters.writeToStream (tree);
+        stream.writeInt64 (static_cast<juce::int64> (tree.getDataSize()));
+        stream.write (tree.getData(), tree.getDataSize());
+
+        const auto canReference = sampleFile.existsAsFile();
+
+        if (sample != nullptr && ! (canReference && ! embedSample))
+        {
+            const auto embedded = encoder.useEncoded (sample, [this, &stream] (const juce::MemoryBlock& flac, float gain)
+            {
+                stream.writeByte (sampleEmbedded);
+                stream.writeString (sampleFile.getFullPathName());
+                stream.writeFloat (gain);
+                stream.writeInt64 (static_cast<juce::int64> (flac.getSize()));
+                stream.write (flac.getData(), flac.getSize());
+            });
+
+            if (embedded)
+                return;
+        }
+
+        if (canReference)
+        {
+            stream.writeByte (sampleReferenced);
+            stream.writeString (sampleFile.getFullPathName());
+            return;
+        }
+
+        stream.writeByte (noSample);
+    }
+
+    /** Parses a block written by write(), decoding an embedded sample.
+        Returns false if the block isn't one.
+    */
+    bool read (const void* data, size_t sizeInBytes)
+    {
+        juce::MemoryInputStream stream (data, sizeInBytes, false);
+
+        if (sizeInBytes < 8 || stream.readInt() != magic)
+            return false;
+
+        const auto version = stream.readInt();
+
+        if (version > currentVersion)
+            return false;
+
+        juce::MemoryBlock tree;
+        const auto treeSize = stream.readInt64();
+
+        if (treeSize <= 0 || treeSize > stream.getNumBytesRemaining()
+             || stream.readIntoMemoryBlock (tree, static_cast<juce::pointer_sized_int> (treeSize)) != static_cast<size_t> (treeSize))
+            return false;
+
+        parameters = juce::ValueTree::readFromData (tree.getData(), tree.getSize());
+
+        const auto kind = stream.readByte();
+
+        if (kind == sampleEmbedded || kind == sampleReferenced)
+        {
+            const auto path = stream.readString();
+
+            if (juce::File::isAbsolutePath (path))
+                sampleFile = juce::File (path);
+        }
+
+        if (kind == sampleEmbedded)
+        {
+            // Version 1 had no gain: its samples were clipped at full scale
+            if (version >= 2)
+            {
+                const auto gain = stream.readFloat();
+                sampleGain = gain > 0.0f && std::isfinite (gain) ? gain : 1.0f;
+            }
+
+            const auto flacSize = stream.readInt64();
+
+            if (flacSize > 0 && flacSize <= stream.getNumBytesRemaining()
+                 && stream.readIntoMemoryBlock (sampleFlac, static_cast<juce::pointer_sized_int> (flacSize)) == static_cast<size_t> (flacSize))
+                sample = decode (sampleFlac, sampleGain);
+
+            if (sample == nullptr)
+            {
+                DBG ("ERROR: The session's embedded sample could not be decoded!");
+                sampleFlac.reset();
+            }
+        }
+
+        return parameters.isValid();
+    }
+
+private:
+    static constexpr int magic = 0x31734353;    // "SCs1"
+    static constexpr int currentVersion = 2;
+
+    enum SampleKind : char { noSample = 0, sampleEmbedded = 1, sampleReferenced = 2 };
+
+    static SampleData::Ptr decode (const juce::MemoryBlock& flac, float gain)
+    {
+        juce::FlacAudioFormat flacFormat;
+        std::unique_ptr<juce::AudioFormatReader> reader (
+            flacFormat.createReaderFor (new juce::MemoryInputStream (flac, false), true));
+
+        return reader != nullptr ? SampleData::fromReader (*reader, SampleRecorder::maxPlayableSeconds, gain)
+                                 : nullptr;
+    }
+};
@@ -2,16 +2,30 @@
   ==============================================================================
 
     TubeSaturation.h
-    
+
     Tube-style saturation with warmth, bias control, and soft-knee compression.
     Implements smooth even-order harmonics via asymmetric waveshaping.
-    
+
     Signal Flow:
-    Input → Upsample 2x → Pre-emphasis → Warmth (low-boost) → Drive → 
-          → Bias + Waveshaper → De-emphasis → Downsample 2x → Output Gain
-    
-    Uses manual 2x oversampling with basic linear interpolation to minimize 
-    aliasing from nonlinear processing.
+    Input → Upsample → Pre-emphasis → Warmth (low-boost) → Drive →
+          → Bias + Waveshaper → De-emphasis → Output Gain → Downsample
+
+    The nonlinear stages run oversampled (1x/2x/4x/8x, see Oversampler) to
+    keep the harmonics they generate from aliasing back into the audio band.
+
+    The oversampled kernel takes up to four channels at once in the lanes of
+    a FastMath::Float4 and uses FastMath::tanh for the waveshaper. Anything
+    that only changes with the parameters (filter designs, the bias DC
+    offset) is worked out when they change, and drive, bias and output gain
+    ramp linearly across each block so automation doesn't zipper. NaN and
+    denormal protection runs once per block on the filter state rather than
+    on every sample. Tools/Benchmarks checks the kernel against the old
+    scalar version (--tube-accuracy).
+
+    All memory is allocated in prepare(), for any number of channels. Blocks
+    longer than the prepared size are processed in pieces of at most that
+    size, so hosts that exceed it (or offline renders with large blocks) are
+    safe.
 
   ==============================================================================
 */
@@ -19,11 +33,13 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "FastMath.h"
+#include "Oversampler.h"
 
 //==============================================================================
 /**
     Tube saturation processor with frequency-dependent saturation and asymmetric
-    harmonic generation. Designed to mimic the warm, smooth compression of 
+    harmonic generation. Designed to mimic the warm, smooth compression of
     vacuum tube circuits.
 */
 class TubeSaturation
@@ -36,31 +52,31 @@ public:
     void prepare(double sampleRate, int samplesPerBlock, int numChannels)
     {
         currentSampleRate = sampleRate;
-        oversampledRate = sampleRate * 2.0;
-        
-        // Allocate oversampled buffer (2x the size for 2x oversampling)
-        oversampledBuffer.setSize(numChannels, samplesPerBlock * 2);
-        
+        maxBlockSize = juce::jmax(1, samplesPerBlock);
+        numPreparedChannels = juce::jmax(1, numChannels);
+
+        oversampler.prepare(sampleRate, maxBlockSize, numPreparedChannels);
+        oversampledRate = sampleRate * oversampler.getFactor();
+
+        // One set of filter states per group of four channels
+        groups.resize(static_cast<size_t>((numPreparedChannels + Float4::size - 1) / Float4::size));
+
         // Initialize filters at oversampled rate
         updateFilterCoefficients();
-        
+
         reset();
     }
 
     void reset()
     {
-        oversampledBuffer.clear();
-        
-        // Reset filter states for both channels
-        for (int ch = 0; ch < 2; ++ch)
-        {
-            preEmphZ1[ch] = 0.0f;
-            preEmphZ2[ch] = 0.0f;
-            deEmphZ1[ch] = 0.0f;
-            deEmphZ2[ch] = 0.0f;
-            warmthZ1[ch] = 0.0f;
-            warmthZ2[ch] = 0.0f;
-        }
+        oversampler.reset();
+
+        // Reset filter states for all channels
+        for (auto& g : groups)
+            g = {};
+
+        // Start the next block on the current settings instead of ramping
+        snapParameters = true;
     }
 
     //==============================================================================
@@ -68,37 +84,46 @@ public:
     {
         const int numChannels = buffer.getNumChannels();
         const int numSamples = buffer.getNumSamples();
-        
+
         if (numChannels == 0 || numSamples == 0)
             return;
-        
-        // Process each channel
-        for (int ch = 0; ch < numChannels; ++ch)
+
+        // Channels beyond the prepared count have no filter state and pass
+        // through untouched
+        jassert(numChannels <= numPreparedChannels);
+        const int numProcessed = juce::jmin(numChannels, numPreparedChannels);
+
+        // The oversampling buffers hold maxBlockSize samples per channel
+        for (int start = 0; start < numSamples; start += maxBlockSize)
         {
-            auto* channelData = buffer.getWritePointer(ch);
-            auto* oversampledData = oversampledBuffer.getWritePointer(ch);
-            
-            // Step 1: Upsample to 2x (linear interpolation)
-            for (int i = 0; i < numSamples; ++i)
-            {
-                float sample = channelData[i];
-                float nextSample = (i < numSamples - 1) ? channelData[i + 1] : sample;
-                
-                oversampledData[i * 2] = sample;
-                oversampledData[i * 2 + 1] = (sample + nextSample) * 0.5f;
-            }
-            
-            // Step 2: Process at oversampled rate
-            processOversampledChannel(oversampledData, numSamples * 2, ch);
-            
-            // Step 3: Downsample back to original rate (simple decimation)
-            for (int i = 0; i < numSamples; ++i)
-            {
-                channelData[i] = oversampledData[i * 2];
-            }
+            const int num = juce::jmin(maxBlockSize, numSamples - start);
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numProcessed, start, num);
+            processBlock(block);
+        }
+    }
+
+    //==============================================================================
+    /** Oversampling factor (1, 2, 4 or 8) and filter type. Changing either
+        clears the oversampling filters, and a new factor redesigns the
+        saturation filters for the new rate.
+    */
+    void setOversampling(int factor, Oversampler::Mode mode)
+    {
+        oversampler.setMode(mode);
+        oversampler.setFactor(factor);
+
+        const double newRate = currentSampleRate * oversampler.getFactor();
+
+        if (newRate != oversampledRate)
+        {
+            oversampledRate = newRate;
+            updateFilterCoefficients();
         }
     }
 
+    /** The delay the oversampling filters add, in samples. */
+    int getLatencySamples() const noexcept { return oversampler.getLatencySamples(); }
+
     //==============================================================================
     // Parameter setters
     void setDrive(float newDrive)
@@ -108,13 +133,22 @@ public:
 
     void setWarmth(float warmthDb)
     {
-        warmth = juce::jlimit(-12.0f, 6.0f, warmthDb);
-        updateWarmthFilter();
+        const float newWarmth = juce::jlimit(-12.0f, 6.0f, warmthDb);
+
+        // Called every block, so only redesign when it actually moved
+        if (newWarmth != warmth)
+        {
+            warmth = newWarmth;
+            updateWarmthFilter();
+        }
     }
 
     void setBias(float newBias)
     {
         bias = juce::jlimit(-1.0f, 1.0f, newBias);
+
+        // DC offset the bias adds to the waveshaper, removed after it
+        dcOffset = (std::abs(bias) > 0.001f) ? std::tanh(bias * 0.25f) : 0.0f;
     }
 
     void setOutputGain(float gainDb)
@@ -123,76 +157,187 @@ public:
     }
 
 private:
+    using Float4 = FastMath::Float4;
+
     //==============================================================================
-    void processOversampledChannel(float* data, int numSamples, int channel)
+    struct Coefficients
+    {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+    };
+
+    struct FilterState
+    {
+        Float4 z1 = Float4::broadcast(0.0f), z2 = Float4::broadcast(0.0f);
+    };
+
+    /** Filter states (z^-1, z^-2) for four channels. */
+    struct GroupState
+    {
+        FilterState preEmph, warmth, deEmph;
+    };
+
+    /** The per-sample parameters, ramped from where the last block ended. */
+    struct KernelParameters
+    {
+        float drive = 1.0f, halfBias = 0.0f, dcOffset = 0.0f, outputGain = 1.0f;
+    };
+
+    //==============================================================================
+    void processBlock(juce::AudioBuffer<float>& block)
+    {
+        // Step 1: Upsample (polyphase half-band filters)
+        auto oversampled = oversampler.processUp(block);
+
+        // Step 2: Saturate all channels at the oversampled rate
+        processOversampled(oversampled);
+
+        // Step 3: Filter and downsample back to the original rate
+        oversampler.processDown(block);
+    }
+
+    void processOversampled(juce::AudioBuffer<float>& block)
+    {
+        const int numSamples = block.getNumSamples();
+        const KernelParameters target { drive, bias * 0.5f, dcOffset, outputGain };
+
+        if (snapParameters)
+        {
+            smoothed = target;
+            snapParameters = false;
+        }
+
+        // Sample i uses start + step * (i + 1), so the block ends on the target
+        const float scale = 1.0f / static_cast<float>(numSamples);
+        const KernelParameters step { (target.drive - smoothed.drive) * scale,
+                                      (target.halfBias - smoothed.halfBias) * scale,
+                                      (target.dcOffset - smoothed.dcOffset) * scale,
+                                      (target.outputGain - smoothed.outputGain) * scale };
+
+        float* const* channels = block.getArrayOfWritePointers();
+        const int numChannels = juce::jmin(block.getNumChannels(), static_cast<int>(groups.size()) * Float4::size);
+
+        for (int first = 0; first < numChannels; first += Float4::size)
+        {
+            auto& state = groups[static_cast<size_t>(first / Float4::size)];
+            const int numLanes = juce::jmin(Float4::size, numChannels - first);
+
+            processGroup(channels + first, numLanes, numSamples, state, step);
+
+            // Block-level safety: a NaN/Inf anywhere in the block ends up in
+            // the filter state, so checking that once replaces per-sample tests
+            if (! isFinite(state))
+            {
+                state = {};
+
+                for (int ch = 0; ch < numLanes; ++ch)
+                    juce::FloatVectorOperations::clear(channels[first + ch], numSamples);
+            }
+            else
+            {
+                snapToZero(state);
+            }
+        }
+
+        smoothed = target;
+    }
+
+    void processGroup(float* const* channels, int numLanes, int numSamples, GroupState& state, const KernelParameters& step) noexcept
     {
+        auto p = smoothed;
+        auto pre = state.preEmph, warm = state.warmth, de = state.deEmph;
+
+        alignas(16) float frame[Float4::size] = {};
+
         for (int i = 0; i < numSamples; ++i)
         {
-            float sample = data[i];
-            
+            p.drive += step.drive;
+            p.halfBias += step.halfBias;
+            p.dcOffset += step.dcOffset;
+            p.outputGain += step.outputGain;
+
+            for (int ch = 0; ch < numLanes; ++ch)
+                frame[ch] = channels[ch][i];
+
+            auto sample = Float4::load(frame);
+
             // Stage 1: Pre-emphasis (gentle high-cut before saturation)
-            sample = applyBiquad(sample, preEmphB0, preEmphB1, preEmphB2, 
-                                preEmphA1, preEmphA2,
-                                preEmphZ1[channel], preEmphZ2[channel]);
-            
+            sample = applyBiquad(sample, preEmph, pre);
+
             // Stage 2: Warmth (low-frequency boost)
-            sample = applyBiquad(sample, warmthB0, warmthB1, warmthB2,
-                                warmthA1, warmthA2,
-                                warmthZ1[channel], warmthZ2[channel]);
-            
+            sample = applyBiquad(sample, warmthFilter, warm);
+
             // Stage 3: Drive
-            sample *= drive;
-            
+            sample = sample * p.drive;
+
             // Stage 4: Bias + Waveshaping (tube-like asymmetry)
             // Adding bias before saturation creates even-order harmonics
-            float biasedSample = sample + (bias * sample * sample * 0.5f);
-            
-            // Soft saturation using tanh (smooth tube-like curve)
-            float saturated = std::tanh(biasedSample);
-            
-            // Remove DC offset from bias
-            if (std::abs(bias) > 0.001f)
-                saturated -= std::tanh(bias * 0.25f);
-            
+            const auto biasedSample = sample + sample * sample * p.halfBias;
+
+            // Soft saturation using tanh (smooth tube-like curve), minus the
+            // DC offset from bias
+            auto saturated = FastMath::tanh(biasedSample) - p.dcOffset;
+
             // Stage 5: De-emphasis (restore high-frequency balance)
-            saturated = applyBiquad(saturated, deEmphB0, deEmphB1, deEmphB2,
-                                   deEmphA1, deEmphA2,
-                                   deEmphZ1[channel], deEmphZ2[channel]);
-            
-            // Stage 6: Output gain
-            saturated *= outputGain;
-            
-            // Safety: sanitize output
-            saturated = sanitize(saturated);
-            
-            data[i] = saturated;
+            saturated = applyBiquad(saturated, deEmph, de);
+
+            // Stage 6: Output gain, hard limited to ±1.0
+            saturated = FastMath::clamp(saturated * p.outputGain, -1.0f, 1.0f);
+
+            saturated.store(frame);
+
+            for (int ch = 0; ch < numLanes; ++ch)
+                channels[ch][i] = frame[ch];
         }
+
+        state.preEmph = pre;
+        state.warmth = warm;
+        state.deEmph = de;
     }
 
     //==============================================================================
     // Biquad filter implementation (Direct Form II)
-    inline float applyBiquad(float input, 
-                            float b0, float b1, float b2,
-                            float a1, float a2,
-                            float& z1, float& z2)
+    static Float4 applyBiquad(Float4 input, const Coefficients& c, FilterState& s) noexcept
     {
-        float output = input * b0 + z1;
-        z1 = input * b1 - a1 * output + z2;
-        z2 = input * b2 - a2 * output;
+        const auto output = input * c.b0 + s.z1;
+        s.z1 = input * c.b1 - output * c.a1 + s.z2;
+        s.z2 = input * c.b2 - output * c.a2;
         return output;
     }
 
+    static bool isFinite(const GroupState& g) noexcept
+    {
+        for (auto* s : { &g.preEmph, &g.warmth, &g.deEmph })
+        {
+            alignas(16) float lanes[2 * Float4::size];
+            s->z1.store(lanes);
+            s->z2.store(lanes + Float4::size);
+
+            for (auto x : lanes)
+                if (! std::isfinite(x))
+                    return false;
+        }
+
+        return true;
+    }
+
+    static void snapToZero(GroupState& g) noexcept
+    {
+        for (auto* s : { &g.preEmph, &g.warmth, &g.deEmph })
+        {
+            s->z1 = FastMath::snapToZero(s->z1);
+            s->z2 = FastMath::snapToZero(s->z2);
+        }
+    }
+
     // Update filter coefficients
     void updateFilterCoefficients()
     {
         // Pre-emphasis: high-shelf cut at 8kHz, -3dB (reduces aliasing)
-        makeHighShelf(8000.0f, 0.707f, -3.0f, oversampledRate,
-                     preEmphB0, preEmphB1, preEmphB2, preEmphA1, preEmphA2);
-        
+        preEmph = makeHighShelf(8000.0f, 0.707f, -3.0f, oversampledRate);
+
         // De-emphasis: reciprocal high-shelf
-        makeHighShelf(8000.0f, 0.707f, 3.0f, oversampledRate,
-                     deEmphB0, deEmphB1, deEmphB2, deEmphA1, deEmphA2);
-        
+        deEmph = makeHighShelf(8000.0f, 0.707f, 3.0f, oversampledRate);
+
         // Warmth filter will be updated when parameter changes
         updateWarmthFilter();
     }
@@ -200,20 +345,18 @@ private:
     void updateWarmthFilter()
     {
         // Warmth: low-shelf at 200Hz, variable gain
-        makeLowShelf(200.0f, 0.707f, warmth, oversampledRate,
-                    warmthB0, warmthB1, warmthB2, warmthA1, warmthA2);
+        warmthFilter = makeLowShelf(200.0f, 0.707f, warmth, oversampledRate);
     }
 
     // High-shelf filter designer
-    void makeHighShelf(float freq, float Q, float gainDb, double sampleRate,
-                      float& b0, float& b1, float& b2, float& a1, float& a2)
+    static Coefficients makeHighShelf(float freq, float Q, float gainDb, double sampleRate)
     {
         float A = std::pow(10.0f, gainDb / 40.0f);
         float w0 = juce::MathConstants<float>::twoPi * freq / static_cast<float>(sampleRate);
         float cosW0 = std::cos(w0);
         float sinW0 = std::sin(w0);
         float alpha = sinW0 / (2.0f * Q);
-        
+
         float sqrtA = std::sqrt(A);
         float b0Unnorm = A * ((A + 1.0f) + (A - 1.0f) * cosW0 + 2.0f * sqrtA * alpha);
         float b1Unnorm = -2.0f * A * ((A - 1.0f) + (A + 1.0f) * cosW0);
@@ -221,25 +364,20 @@ private:
         float a0 = (A + 1.0f) - (A - 1.0f) * cosW0 + 2.0f * sqrtA * alpha;
         float a1Unnorm = 2.0f * ((A - 1.0f) - (A + 1.0f) * cosW0);
         float a2Unnorm = (A + 1.0f) - (A - 1.0f) * cosW0 - 2.0f * sqrtA * alpha;
-        
+
         // Normalize
-        b0 = b0Unnorm / a0;
-        b1 = b1Unnorm / a0;
-        b2 = b2Unnorm / a0;
-        a1 = a1Unnorm / a0;
-        a2 = a2Unnorm / a0;
+        return { b0Unnorm / a0, b1Unnorm / a0, b2Unnorm / a0, a1Unnorm / a0, a2Unnorm / a0 };
     }
 
     // Low-shelf filter designer
-    void makeLowShelf(float freq, float Q, float gainDb, double sampleRate,
-                     float& b0, float& b1, float& b2, float& a1, float& a2)
+    static Coefficients makeLowShelf(float freq, float Q, float gainDb, double sampleRate)
     {
         float A = std::pow(10.0f, gainDb / 40.0f);
         float w0 = juce::MathConstants<float>::twoPi * freq / static_cast<float>(sampleRate);
         float cosW0 = std::cos(w0);
         float sinW0 = std::sin(w0);
         float alpha = sinW0 / (2.0f * Q);
-        
+
         float sqrtA = std::sqrt(A);
         float b0Unnorm = A * ((A + 1.0f) - (A - 1.0f) * cosW0 + 2.0f * sqrtA * alpha);
         float b1Unnorm = 2.0f * A * ((A - 1.0f) - (A + 1.0f) * cosW0);
@@ -247,60 +385,34 @@ private:
         float a0 = (A + 1.0f) + (A - 1.0f) * cosW0 + 2.0f * sqrtA * alpha;
         float a1Unnorm = -2.0f * ((A - 1.0f) + (A + 1.0f) * cosW0);
         float a2Unnorm = (A + 1.0f) + (A - 1.0f) * cosW0 - 2.0f * sqrtA * alpha;
-        
-        // Normalize
-        b0 = b0Unnorm / a0;
-        b1 = b1Unnorm / a0;
-        b2 = b2Unnorm / a0;
-        a1 = a1Unnorm / a0;
-        a2 = a2Unnorm / a0;
-    }
 
-    // Sanitize output (denormal + NaN protection)
-    inline float sanitize(float x)
-    {
-        if (!std::isfinite(x))
-            return 0.0f;
-        
-        // Flush denormals to zero
-        if (std::abs(x) < 1e-15f)
-            return 0.0f;
-        
-        // Hard limit to ±1.0
-        return juce::jlimit(-1.0f, 1.0f, x);
+        // Normalize
+        return { b0Unnorm / a0, b1Unnorm / a0, b2Unnorm / a0, a1Unnorm / a0, a2Unnorm / a0 };
     }
 
     //==============================================================================
-    // Oversampled processing buffer
-    juce::AudioBuffer<float> oversampledBuffer;
-    
-    // Filter coefficients (at 2x sample rate)
-    float preEmphB0 = 0.0f, preEmphB1 = 0.0f, preEmphB2 = 0.0f;
-    float preEmphA1 = 0.0f, preEmphA2 = 0.0f;
-    
-    float deEmphB0 = 0.0f, deEmphB1 = 0.0f, deEmphB2 = 0.0f;
-    float deEmphA1 = 0.0f, deEmphA2 = 0.0f;
-    
-    float warmthB0 = 0.0f, warmthB1 = 0.0f, warmthB2 = 0.0f;
-    float warmthA1 = 0.0f, warmthA2 = 0.0f;
-    
-    // Filter states (z^-1, z^-2) for each channel
-    float preEmphZ1[2] = {0.0f, 0.0f};
-    float preEmphZ2[2] = {0.0f, 0.0f};
-    float deEmphZ1[2] = {0.0f, 0.0f};
-    float deEmphZ2[2] = {0.0f, 0.0f};
-    float warmthZ1[2] = {0.0f, 0.0f};
-    float warmthZ2[2] = {0.0f, 0.0f};
-    
-    // Parameters
+    // Up/downsampling around the nonlinear stages
+    Oversampler oversampler;
+
+    // Filter coefficients (at the oversampled rate)
+    Coefficients preEmph, deEmph, warmthFilter;
+
+    // Filter states for each group of four channels
+    std::vector<GroupState> groups;
+
+    // Parameters (targets), plus where the ramps ended last block
     float drive = 1.0f;
     float warmth = 0.0f;
     float bias = 0.0f;
+    float dcOffset = 0.0f;
     float outputGain = 1.0f;
-    
+    KernelParameters smoothed;
+    bool snapParameters = true;
+
     double currentSampleRate = 44100.0;
     double oversampledRate = 88200.0;
+    int maxBlockSize = 512;
+    int numPreparedChannels = 2;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TubeSaturation)
 };
-
@@ -0,0 +1,393 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Static Currents DSP microbenchmarks.
+
+    Times every stage of EffectsChain in isolation, plus the full chain, for
+    each combination of block size, sample rate and (for the saturation and
+    full-chain rows) saturation type. Each measurement runs the stage on a
+    fresh copy of the same stereo noise block, so only the stage itself is
+    on the clock.
+
+    Results are reported as nanoseconds per stereo sample frame and as the
+    percentage of the realtime budget (the sample period) that costs, so
+    regressions between builds show up as a diff of the CSV/JSON output.
+
+    --tube-accuracy instead checks the vectorised TubeSaturation kernel
+    against a frozen copy of the scalar one (TubeSaturationReference.h):
+    maximum and RMS difference and the speed-up, for a grid of settings and
+    every oversampling factor. It fails if any difference exceeds the
+    tolerance.
+
+    --oversized-blocks checks that EffectsChain::process() copes with host
+    blocks larger than the one it was prepared for: legacy saturation
+    (type 2) and bypass at 8x oversampling, on blocks four times the
+    prepared size. The output must be finite and identical to the same
+    audio processed in prepared-size blocks.
+
+    Usage:
+        StaticCurrentsBenchmarks [--csv file] [--json file] [--quick]
+                                 [--seconds S]
+        StaticCurrentsBenchmarks --tube-accuracy
+        StaticCurrentsBenchmarks --oversized-blocks
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/EffectsChain.h"
+#include "TubeSaturationReference.h"
+
+//==============================================================================
+namespace
+{
+    struct Stage
+    {
+        const char* name;
+        bool perSaturationType;
+        std::function<void (EffectsChain&, juce::AudioBuffer<float>&, const ChainParameters&)> run;
+    };
+
+    struct Measurement
+    {
+        juce::String stage;
+        int saturationType;
+        double sampleRate;
+        int blockSize;
+        double nsPerSample;
+        double realtimePercent;
+    };
+
+    const std::vector<Stage>& getStages()
+    {
+        static const std::vector<Stage> stages
+        {
+            { "smoothing",    false, [] (auto& c, auto& b, auto& p) { c.smoothParameters (p, b.getNumSamples()); } },
+            { "gain",         false, [] (auto& c, auto& b, auto& p) { c.processInputGain (b, p); } },
+            { "eq_update",    false, [] (auto& c, auto& b, auto& p) { c.updateEQ (b.getNumSamples(), p); } },
+            { "hpf_cascade",  false, [] (auto& c, auto& b, auto&)   { c.processHighPass (b); } },
+            { "peak_bands",   false, [] (auto& c, auto& b, auto&)   { c.processPeakBands (b); } },
+            { "lpf_cascade",  false, [] (auto& c, auto& b, auto&)   { c.processLowPass (b); } },
+            { "eq",           false, [] (auto& c, auto& b, auto& p) { c.processEQ (b, p); } },
+            { "compressor",   false, [] (auto& c, auto& b, auto& p) { c.processCompressor (b, p); } },
+            { "saturation",   true,  [] (auto& c, auto& b, auto& p) { c.processSaturation (b, p); } },
+            { "output",       false, [] (auto& c, auto& b, auto& p) { c.processOutput (b, p); } },
+            { "full_chain",   true,  [] (auto& c, auto& b, auto& p) { c.process (b, p); } },
+        };
+
+        return stages;
+    }
+
+    /** A representative, fairly heavy setting: 48 dB/oct filters, all peak
+        bands active and the compressor working on the test signal.
+    */
+    ChainParameters createBenchmarkParameters (int saturationType)
+    {
+        ChainParameters p;
+        p.saturationType = saturationType;
+        p.hpfFreq = 80.0f;
+        p.hpfSlope = 4.0f;
+        p.lpfFreq = 12000.0f;
+        p.lpfSlope = 4.0f;
+        p.peak1Gain = 3.0f;
+        p.peak2Gain = -2.0f;
+        p.peak3Gain = 2.0f;
+        p.peak4Gain = -3.0f;
+        p.compThresh = -24.0f;
+        return p;
+    }
+
+    Measurement measure (const Stage& stage, int saturationType, double sampleRate, int blockSize, double secondsOfAudio)
+    {
+        const auto params = createBenchmarkParameters (saturationType);
+
+        EffectsChain chain;
+        chain.prepare (sampleRate, blockSize, 2, params);
+        chain.updateEQ (blockSize, params);
+
+        // Stereo noise at about -12 dBFS, identical for every run
+        juce::Random random (0x5c5c);
+        juce::AudioBuffer<float> source (2, blockSize), work (2, blockSize);
+
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                source.setSample (ch, i, (random.nextFloat() * 2.0f - 1.0f) * 0.25f);
+
+        const int numBlocks = juce::jmax (64, static_cast<int> (secondsOfAudio * sampleRate / blockSize));
+        const int numWarmUpBlocks = 16;
+        juce::int64 ticks = 0;
+
+        for (int block = -numWarmUpBlocks; block < numBlocks; ++block)
+        {
+            work.makeCopyOf (source, true);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            stage.run (chain, work, params);
+            const auto end = juce::Time::getHighResolutionTicks();
+
+            if (block >= 0)
+                ticks += end - start;
+        }
+
+        const double nsPerSample = juce::Time::highResolutionTicksToSeconds (ticks) * 1.0e9
+                                     / (static_cast<double> (numBlocks) * blockSize);
+
+        return { stage.name, stage.perSaturationType ? saturationType : 0, sampleRate, blockSize,
+                 nsPerSample, nsPerSample * sampleRate * 1.0e-7 };
+    }
+
+    juce::String toCSV (const std::vector<Measurement>& results)
+    {
+        juce::String csv ("stage,saturation_type,sample_rate,block_size,ns_per_sample,realtime_percent\n");
+
+        for (auto& r : results)
+            csv << r.stage << ',' << r.saturationType << ',' << juce::String (r.sampleRate, 0) << ','
+                << r.blockSize << ',' << juce::String (r.nsPerSample, 3) << ',' << juce::String (r.realtimePercent, 4) << '\n';
+
+        return csv;
+    }
+
+    juce::String toJSON (const std::vector<Measurement>& results)
+    {
+        juce::Array<juce::var> rows;
+
+        for (auto& r : results)
+        {
+            auto* row = new juce::DynamicObject();
+            row->setProperty ("stage", r.stage);
+            row->setProperty ("saturationType", r.saturationType);
+            row->setProperty ("sampleRate", r.sampleRate);
+            row->setProperty ("blockSize", r.blockSize);
+            row->setProperty ("nsPerSample", r.nsPerSample);
+            row->setProperty ("realtimePercent", r.realtimePercent);
+            rows.add (juce::var (row));
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty ("benchmark", "StaticCurrents EffectsChain");
+        root->setProperty ("unit", "ns per stereo sample frame");
+        root->setProperty ("results", rows);
+
+        return juce::JSON::toString (juce::var (root));
+    }
+
+    //==============================================================================
+    struct TubeSettings
+    {
+        float drive, warmthDb, bias, outputDb;
+    };
+
+    /** Renders the signal through a freshly prepared saturator block by block,
+        returning the ticks spent in process().
+    */
+    template <typename Saturator>
+    juce::int64 renderTube (juce::AudioBuffer<float>& audio, const TubeSettings& settings, int factor, int blockSize)
+    {
+        Saturator saturator;
+        saturator.prepare (48000.0, blockSize, audio.getNumChannels());
+        saturator.setOversampling (factor, Oversampler::Mode::minimumPhase);
+        saturator.setDrive (settings.drive);
+        saturator.setWarmth (settings.warmthDb);
+        saturator.setBias (settings.bias);
+        saturator.setOutputGain (settings.outputDb);
+
+        juce::int64 ticks = 0;
+
+        for (int start = 0; start < audio.getNumSamples(); start += blockSize)
+        {
+            const int num = juce::jmin (blockSize, audio.getNumSamples() - start);
+            juce::AudioBuffer<float> block (audio.getArrayOfWritePointers(), audio.getNumChannels(), start, num);
+
+            const auto begin = juce::Time::getHighResolutionTicks();
+            saturator.process (block);
+            ticks += juce::Time::getHighResolutionTicks() - begin;
+        }
+
+        return ticks;
+    }
+
+    int runTubeAccuracy()
+    {
+        // FastMath::tanh is within 1e-4 of std::tanh; the de-emphasis shelf and
+        // up to +12 dB of output gain scale that by at most ~6
+        const float tolerance = 1.0e-3f;
+        const int blockSize = 512;
+
+        // Two seconds of stereo: a swept sine on the left, noise on the right
+        juce::Random random (0x7ab3);
+        juce::AudioBuffer<float> source (2, 96000);
+
+        for (int i = 0; i < source.getNumSamples(); ++i)
+        {
+            const double t = i / 48000.0;
+            source.setSample (0, i, 0.8f * static_cast<float> (std::sin (juce::MathConstants<double>::twoPi * (50.0 + 5000.0 * t) * t)));
+            source.setSample (1, i, (random.nextFloat() * 2.0f - 1.0f) * 0.5f);
+        }
+
+        const TubeSettings grid[] = { { 0.5f, -12.0f, 0.0f, 0.0f }, { 4.0f, -3.0f, 0.0f, 0.0f }, { 4.0f, -3.0f, 0.6f, 0.0f },
+                                      { 10.0f, 6.0f, -1.0f, 12.0f }, { 10.0f, 6.0f, 1.0f, -12.0f }, { 2.0f, 0.0f, 0.3f, 6.0f } };
+
+        bool passed = true;
+        std::cout << "drive,warmth_db,bias,output_db,factor,max_error,rms_error,speedup" << std::endl;
+
+        for (auto& settings : grid)
+        {
+            for (int factor : { 1, 2, 4, 8 })
+            {
+                juce::AudioBuffer<float> fast, reference;
+                fast.makeCopyOf (source);
+                reference.makeCopyOf (source);
+
+                const auto fastTicks = renderTube<TubeSaturation> (fast, settings, factor, blockSize);
+                const auto referenceTicks = renderTube<TubeSaturationReference> (reference, settings, factor, blockSize);
+
+                double maxError = 0.0, sumSquares = 0.0;
+
+                for (int ch = 0; ch < source.getNumChannels(); ++ch)
+                {
+                    for (int i = 0; i < source.getNumSamples(); ++i)
+                    {
+                        const double error = std::abs (fast.getSample (ch, i) - reference.getSample (ch, i));
+                        maxError = juce::jmax (maxError, error);
+                        sumSquares += error * error;
+                    }
+                }
+
+                const double rmsError = std::sqrt (sumSquares / (source.getNumChannels() * source.getNumSamples()));
+                const double speedup = static_cast<double> (referenceTicks) / static_cast<double> (juce::jmax ((juce::int64) 1, fastTicks));
+                passed = passed && maxError <= tolerance;
+
+                std::cout << settings.drive << ',' << settings.warmthDb << ',' << settings.bias << ',' << settings.outputDb << ','
+                          << factor << ',' << juce::String (maxError, 7) << ',' << juce::String (rmsError, 8) << ','
+                          << juce::String (speedup, 2) << std::endl;
+            }
+        }
+
+        std::cerr << (passed ? "PASS" : "FAIL") << ": tolerance " << tolerance << std::endl;
+        return passed ? 0 : 1;
+    }
+
+    //==============================================================================
+    // Renders audio through a fresh chain in blocks of blockSize
+    void renderChain (juce::AudioBuffer<float>& audio, const ChainParameters& params, int preparedBlockSize, int blockSize)
+    {
+        EffectsChain chain;
+        chain.prepare (48000.0, preparedBlockSize, audio.getNumChannels(), params);
+
+        for (int start = 0; start < audio.getNumSamples(); start += blockSize)
+        {
+            const int num = juce::jmin (blockSize, audio.getNumSamples() - start);
+            juce::AudioBuffer<float> block (audio.getArrayOfWritePointers(), audio.getNumChannels(), start, num);
+            chain.process (block, params);
+        }
+    }
+
+    int runOversizedBlocks()
+    {
+        const int preparedBlockSize = 512;
+        const int hostBlockSize = preparedBlockSize * 4;
+
+        juce::Random random (0x0b10);
+        juce::AudioBuffer<float> source (2, hostBlockSize * 8);
+
+        for (int ch = 0; ch < source.getNumChannels(); ++ch)
+            for (int i = 0; i < source.getNumSamples(); ++i)
+                source.setSample (ch, i, (random.nextFloat() * 2.0f - 1.0f) * 0.5f);
+
+        bool passed = true;
+
+        for (bool bypass : { false, true })
+        {
+            auto params = createBenchmarkParameters (2);
+            params.saturation = 1.0f;
+            params.oversamplingFactor = 8;
+            params.bypass = bypass;
+
+            juce::AudioBuffer<float> oversized, reference;
+            oversized.makeCopyOf (source);
+            reference.makeCopyOf (source);
+
+            renderChain (oversized, params, preparedBlockSize, hostBlockSize);
+            renderChain (reference, params, preparedBlockSize, preparedBlockSize);
+
+            bool finite = true;
+            double maxError = 0.0;
+
+            for (int ch = 0; ch < source.getNumChannels(); ++ch)
+            {
+                for (int i = 0; i < source.getNumSamples(); ++i)
+                {
+                    finite = finite && std::isfinite (oversized.getSample (ch, i));
+                    maxError = juce::jmax (maxError, static_cast<double> (std::abs (oversized.getSample (ch, i) - reference.getSample (ch, i))));
+                }
+            }
+
+            const bool ok = finite && maxError == 0.0;
+            passed = passed && ok;
+
+            std::cerr << (bypass ? "bypass" : "saturation type 2") << ", 8x, " << hostBlockSize << "-sample blocks (prepared for "
+                      << preparedBlockSize << "): " << (ok ? "ok" : "mismatch") << ", max difference "
+                      << juce::String (maxError, 9) << (finite ? "" : ", non-finite output") << std::endl;
+        }
+
+        std::cerr << (passed ? "PASS" : "FAIL") << std::endl;
+        return passed ? 0 : 1;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+    juce::ScopedNoDenormals noDenormals;
+
+    if (args.containsOption ("--tube-accuracy"))
+        return runTubeAccuracy();
+
+    if (args.containsOption ("--oversized-blocks"))
+        return runOversizedBlocks();
+
+    const bool quick = args.containsOption ("--quick");
+    const double secondsOfAudio = args.containsOption ("--seconds") ? args.getValueForOption ("--seconds").getDoubleValue()
+                                                                    : (quick ? 0.1 : 0.5);
+
+    const std::vector<int> blockSizes = quick ? std::vector<int> { 64, 512, 4096 }
+                                              : std::vector<int> { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    const std::vector<double> sampleRates = quick ? std::vector<double> { 48000.0 }
+                                                  : std::vector<double> { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+
+    std::vector<Measurement> results;
+
+    for (auto& stage : getStages())
+    {
+        for (int saturationType = 1; saturationType <= (stage.perSaturationType ? 6 : 1); ++saturationType)
+        {
+            for (auto sampleRate : sampleRates)
+            {
+                for (auto blockSize : blockSizes)
+                {
+                    results.push_back (measure (stage, saturationType, sampleRate, blockSize, secondsOfAudio));
+
+                    auto& r = results.back();
+                    std::cerr << r.stage << " sat=" << r.saturationType << " sr=" << r.sampleRate
+                              << " block=" << r.blockSize << ": " << juce::String (r.nsPerSample, 2) << " ns/sample ("
+                              << juce::String (r.realtimePercent, 3) << "% realtime)" << std::endl;
+                }
+            }
+        }
+    }
+
+    const auto csv = toCSV (results);
+
+    if (args.containsOption ("--csv"))
+        args.getFileForOption ("--csv").replaceWithText (csv);
+    else
+        std::cout << csv;
+
+    if (args.containsOption ("--json"))
+        args.getFileForOption ("--json").replaceWithText (toJSON (results));
+
+    return 0;
+}
@@ -0,0 +1,216 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Static Currents headless renderer.
+
+    Links the plugin's processor (without the editor) into a console app and
+    renders audio files through the effects chain, using the same export jobs
+    as the plugin's batch export. Parameters come from a profile in the
+    preset bank (by index or name) and/or a JSON parameter file.
+
+    Usage:
+        StaticCurrentsRenderer [--profile N|name] [--params file.json]
+                               [--format wav|flac|ogg|mp3] [--block-size N]
+                               [--output dir] input...
+
+    Inputs can be audio files or folders (all audio files directly inside).
+
+    A parameter file is a JSON object of parameter names to values, e.g.
+        { "profile": "Cassette", "tubeDrive": 6.5, "compThresh": -18 }
+    "profile" is applied first; every other key overrides a single parameter.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+//==============================================================================
+namespace
+{
+    void printUsage()
+    {
+        std::cout << "Usage: StaticCurrentsRenderer [--profile N|name] [--params file.json]" << std::endl
+                  << "                              [--format wav|flac|ogg|mp3] [--block-size N]" << std::endl
+                  << "                              [--output dir] input..." << std::endl
+                  << std::endl
+                  << "Parameters:" << std::endl
+                  << "  " << StaticCurrentsPluginAudioProcessor::getParameterNames().joinIntoString (", ") << std::endl;
+    }
+
+    /** A preset's index, or its name in the preset bank. */
+    juce::Result applyProfile (StaticCurrentsPluginAudioProcessor& processor, const juce::String& profile)
+    {
+        const auto& bank = processor.getPresetBank();
+        const auto name = profile.trim();
+        const int index = name.isNotEmpty() && name.containsOnly ("0123456789") ? name.getIntValue()
+                                                                                : bank.indexOf (name);
+
+        if (! juce::isPositiveAndBelow (index, bank.getNumPresets()))
+            return juce::Result::fail ("Unknown profile: " + profile);
+
+        processor.applyProfilePreset (index);
+        return juce::Result::ok();
+    }
+
+    juce::Result applyParameterFile (StaticCurrentsPluginAudioProcessor& processor, const juce::File& file)
+    {
+        if (! file.existsAsFile())
+            return juce::Result::fail ("Parameter file not found: " + file.getFullPathName());
+
+        auto json = juce::JSON::parse (file);
+        auto* object = json.getDynamicObject();
+
+        if (object == nullptr)
+            return juce::Result::fail ("Parameter file is not a JSON object: " + file.getFullPathName());
+
+        const auto& properties = object->getProperties();
+
+        if (properties.contains ("profile"))
+        {
+            auto result = applyProfile (processor, properties["profile"].toString());
+
+            if (result.failed())
+                return result;
+        }
+
+        for (const auto& property : properties)
+        {
+            const auto name = property.name.toString();
+
+            if (name == "profile")
+                continue;
+
+            if (name == "bypass")
+            {
+                processor.setBypassed (static_cast<bool> (property.value));
+                continue;
+            }
+
+            auto* parameter = processor.findParameter (name);
+
+            if (parameter == nullptr)
+                return juce::Result::fail ("Unknown parameter in " + file.getFileName() + ": " + name);
+
+            parameter->store (static_cast<float> (property.value));
+        }
+
+        return juce::Result::ok();
+    }
+
+    juce::Array<juce::File> collectInputs (const juce::StringArray& paths)
+    {
+        juce::Array<juce::File> inputs;
+
+        for (auto& path : paths)
+        {
+            auto file = juce::File::getCurrentWorkingDirectory().getChildFile (path);
+
+            if (file.isDirectory())
+            {
+                auto children = file.findChildFiles (juce::File::findFiles, false, BatchExporter::getSupportedWildcard());
+                children.sort();
+                inputs.addArray (children);
+            }
+            else if (file.existsAsFile())
+            {
+                inputs.add (file);
+            }
+            else
+            {
+                std::cerr << "Skipping missing input: " << path << std::endl;
+            }
+        }
+
+        return inputs;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if (args.size() == 0 || args.containsOption ("--help|-h"))
+    {
+        printUsage();
+        return args.size() == 0 ? 1 : 0;
+    }
+
+    StaticCurrentsPluginAudioProcessor processor;
+
+    if (args.containsOption ("--profile"))
+    {
+        auto result = applyProfile (processor, args.getValueForOption ("--profile"));
+
+        if (result.failed())
+        {
+            std::cerr << result.getErrorMessage() << std::endl;
+            return 1;
+        }
+    }
+
+    if (args.containsOption ("--params"))
+    {
+        auto result = applyParameterFile (processor, args.getFileForOption ("--params"));
+
+        if (result.failed())
+        {
+            std::cerr << result.getErrorMessage() << std::endl;
+            return 1;
+        }
+    }
+
+    auto format = args.containsOption ("--format") ? args.getValueForOption ("--format").trimCharactersAtStart (".")
+                                                   : juce::String ("wav");
+    auto blockSize = args.containsOption ("--block-size") ? args.getValueForOption ("--block-size").getIntValue() : 512;
+    auto outputDirectory = args.containsOption ("--output") ? args.getFileForOption ("--output")
+                                                            : juce::File::getCurrentWorkingDirectory().getChildFile ("Processed");
+
+    // Everything that isn't an option (or an option's value) is an input
+    juce::StringArray inputPaths;
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        if (args[i].isOption())
+        {
+            if (! args[i].text.containsChar ('=') && ! (args[i] == "--help|-h"))
+                ++i;
+
+            continue;
+        }
+
+        inputPaths.add (args[i].text);
+    }
+
+    auto inputs = collectInputs (inputPaths);
+
+    if (inputs.isEmpty())
+    {
+        std::cerr << "No input audio files." << std::endl;
+        return 1;
+    }
+
+    BatchExporter batch;
+
+    if (batch.start (inputs, outputDirectory, "." + format, processor.getChainParameters(), blockSize) == 0)
+    {
+        std::cerr << "Could not start render into " << outputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    while (batch.isRunning())
+    {
+        std::cout << "\rRendering " << batch.getNumFiles() << " files... "
+                  << juce::roundToInt (batch.getProgress() * 100.0f) << "%" << std::flush;
+        juce::Thread::sleep (100);
+    }
+
+    std::cout << std::endl << batch.createReport() << std::endl;
+    batch.writeReport();
+
+    return batch.getNumFinished() == batch.getNumFiles() ? 0 : 1;
+}